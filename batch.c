@@ -0,0 +1,684 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "batch.h"
+#include "batchIo.h"
+#include "imageArena.h"
+#include "imageStream.h"
+#include "streamConvert.h"
+
+// Each worker owns a range of jobs, held as one word so that it can be changed with a single compare and swap.
+// The first job still waiting is in the high half and one past the last in the low half.
+// The owner takes jobs from the bottom and idle workers steal from the top, so the two rarely meet.
+typedef struct BatchDeque
+{
+    uint64_t range;
+    // keep each deque on its own cache line so workers do not slow each other down
+    char padding[64 - sizeof(uint64_t)];
+} BatchDeque;
+
+// Everything the workers of one batch share.
+typedef struct BatchPool
+{
+    struct BatchJob *jobs;
+    long jobCount;
+    unsigned short outputMagic;
+    struct BatchDeque *deques;
+    int workerCount;
+    // how the workers move their files, from selectBatchIo
+    int ioMode;
+} BatchPool;
+
+// What a slot of a worker is waiting for.
+#define BATCH_SLOT_FREE 0
+#define BATCH_SLOT_READING 1
+#define BATCH_SLOT_WRITING 2
+#define BATCH_SLOT_CLOSING 3
+
+// The tag of an operation names its slot, and whether it closes the slot's input.
+#define BATCH_TAG_INPUT 1
+
+// One small image a worker has on the go. Its file is read whole into the slot's part of the worker's
+// buffers, converted in memory into the slot's output block and written out, while the kernel reads
+// and writes the files of the other slots.
+typedef struct BatchSlot
+{
+    struct BatchJob *job;
+    int state;
+    int inputFile, outputFile, inputClosing;
+    // the input's device and inode, which tell whether the output would overwrite it
+    dev_t device;
+    ino_t inode;
+    unsigned char *input;
+    size_t inputSize;
+    unsigned char *output;
+    size_t outputSize, outputCapacity;
+    // bytes read or written so far
+    size_t done;
+} BatchSlot;
+
+// A worker thread and the blocks it reuses for every file it converts.
+typedef struct BatchWorker
+{
+    struct BatchPool *pool;
+    int index;
+    pthread_t thread;
+    int running;
+    struct ImageReader reader;
+    struct ImageWriter writer;
+    unsigned char *strip;
+    // the small images on the go, and the buffers their files are read into
+    struct BatchSlot slots[BATCH_IO_SLOTS];
+    struct BatchRing ring;
+    unsigned char *buffers;
+    size_t buffersCapacity;
+    // Output blocks which are not being written, the one written last on top. The writer takes the top one
+    // for the next image, which is the one most likely to still be in cache.
+    unsigned char *spares[BATCH_IO_SLOTS];
+    size_t spareCapacities[BATCH_IO_SLOTS];
+    int spareCount;
+} BatchWorker;
+
+// This function builds the word for a range of jobs.
+static inline uint64_t batchRange(uint32_t top, uint32_t bottom)
+{
+    return ((uint64_t)top << 32) | bottom;
+}
+
+// This function takes a job off the bottom of a worker's own deque.
+// It returns -1 once the deque is empty.
+static long popBatchJob(struct BatchDeque *deque)
+{
+    uint64_t range = __atomic_load_n(&deque->range, __ATOMIC_ACQUIRE);
+    for (;;)
+    {
+        uint32_t top = (uint32_t)(range >> 32), bottom = (uint32_t)range;
+        if (top >= bottom)
+            return -1;
+        if (__atomic_compare_exchange_n(&deque->range, &range, batchRange(top, bottom - 1), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            return bottom - 1;
+    }
+}
+
+// This function steals a job off the top of another worker's deque.
+// It returns -1 once the deque is empty.
+static long stealBatchJob(struct BatchDeque *deque)
+{
+    uint64_t range = __atomic_load_n(&deque->range, __ATOMIC_ACQUIRE);
+    for (;;)
+    {
+        uint32_t top = (uint32_t)(range >> 32), bottom = (uint32_t)range;
+        if (top >= bottom)
+            return -1;
+        if (__atomic_compare_exchange_n(&deque->range, &range, batchRange(top + 1, bottom), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            return top;
+    }
+}
+
+// This function finds the next job for a worker, from its own deque first and then from the others in turn.
+// It returns -1 when every deque is empty. No jobs are ever added, so an empty pool stays empty.
+static long takeBatchJob(struct BatchPool *pool, int index)
+{
+    long job = popBatchJob(&pool->deques[index]);
+    for (int other = 1; job < 0 && other < pool->workerCount; other++)
+        job = stealBatchJob(&pool->deques[(index + other) % pool->workerCount]);
+    return job;
+}
+
+// This function converts one job with the worker's reader, writer and strip.
+static void runBatchJob(struct BatchJob *job, unsigned short outputMagic, struct ImageReader *reader, struct ImageWriter *writer, unsigned char *strip)
+{
+    // a job failed while naming the outputs keeps its error
+    if (job->check != SUCCESS)
+        return;
+    if (strip == NULL)
+    {
+        job->check = BAD_MALLOC;
+        return;
+    }
+
+    const struct ImageCodec *inputCodec = detectImageCodec(job->inputName, &job->check);
+    if (inputCodec == NULL)
+        return;
+
+    // an output which is the input would be truncated before it was read
+    if (isSameFile(job->inputName, job->outputName))
+    {
+        job->check = BAD_FILE;
+        job->failedName = job->outputName;
+        return;
+    }
+    job->check = convertImageStream(reader, writer, strip, job->inputName, inputCodec->magicNumber, job->outputName, outputMagic, &job->failedName);
+}
+
+// This function starts a job on a free slot by opening its input and queuing a read of the whole file.
+// It returns 0, with nothing queued, for a job which is to go through runBatchJob instead: one which has
+// already failed, an input which cannot be opened, so that it is reported just as before, and an input
+// which is not a regular file of at most BATCH_IO_SLOT_BYTES.
+static int startBatchSlot(struct BatchWorker *worker, struct BatchSlot *slot, struct BatchJob *job, uint64_t tag)
+{
+    if (job->check != SUCCESS)
+        return 0;
+    int inputFile = open(job->inputName, O_RDONLY);
+    if (inputFile < 0)
+        return 0;
+    struct stat status;
+    if (fstat(inputFile, &status) != 0 || !S_ISREG(status.st_mode) || status.st_size == 0 || status.st_size > BATCH_IO_SLOT_BYTES)
+    {
+        close(inputFile);
+        return 0;
+    }
+
+    slot->job = job;
+    slot->state = BATCH_SLOT_READING;
+    slot->inputFile = inputFile;
+    slot->device = status.st_dev;
+    slot->inode = status.st_ino;
+    slot->inputSize = (size_t)status.st_size;
+    slot->done = 0;
+    queueBatchRead(&worker->ring, inputFile, slot->input, slot->inputSize, 0, tag);
+    return 1;
+}
+
+// This function converts the input a slot has read into an output block of its own and creates the output file.
+// The checks and their order are those of runBatchJob, and the output is only created once the whole
+// image has converted, so every input error is found before anything is written.
+static int convertBatchSlot(struct BatchWorker *worker, struct BatchSlot *slot)
+{
+    struct BatchJob *job = slot->job;
+    struct ImageWriter *writer = &worker->writer;
+    const struct ImageCodec *inputCodec = slot->done >= 2 ? findImageCodec((unsigned short)(slot->input[0] | slot->input[1] << 8)) : NULL;
+    if (inputCodec == NULL)
+        return BAD_MAGIC_NUMBER;
+
+    // an output which is the input would be truncated before it was read
+    struct stat status;
+    if (stat(job->outputName, &status) == 0 && status.st_dev == slot->device && status.st_ino == slot->inode)
+    {
+        job->failedName = job->outputName;
+        return BAD_FILE;
+    }
+    int check = convertImageBytes(&worker->reader, writer, worker->strip, slot->input, slot->done, inputCodec->magicNumber, worker->pool->outputMagic);
+    if (check != SUCCESS)
+        return check;
+    slot->outputFile = open(job->outputName, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (slot->outputFile < 0)
+    {
+        job->failedName = job->outputName;
+        return BAD_FILE;
+    }
+
+    // the image stays with the slot until it is written, and the writer goes on with a spare block
+    slot->output = writer->memory;
+    slot->outputCapacity = writer->memoryCapacity;
+    slot->outputSize = writer->memoryUsed;
+    writer->memory = NULL;
+    writer->memoryCapacity = 0;
+    if (worker->spareCount > 0)
+    {
+        worker->spareCount--;
+        writer->memory = worker->spares[worker->spareCount];
+        writer->memoryCapacity = worker->spareCapacities[worker->spareCount];
+    }
+    return SUCCESS;
+}
+
+// This function moves a slot on once its read, write or close has finished with result.
+// A read or write which comes up short is queued again for the rest.
+static void advanceBatchSlot(struct BatchWorker *worker, struct BatchSlot *slot, long result, uint64_t tag)
+{
+    struct BatchJob *job = slot->job;
+    if (slot->state == BATCH_SLOT_READING)
+    {
+        if (result > 0 && slot->done + (size_t)result < slot->inputSize)
+        {
+            slot->done += (size_t)result;
+            queueBatchRead(&worker->ring, slot->inputFile, slot->input + slot->done, slot->inputSize - slot->done, (off_t)slot->done, tag);
+            return;
+        }
+        queueBatchClose(&worker->ring, slot->inputFile, tag | BATCH_TAG_INPUT);
+        slot->inputClosing = 1;
+        slot->state = BATCH_SLOT_FREE;
+        // a file which cannot be read after all is left to the streaming converter to report
+        if (result < 0)
+        {
+            runBatchJob(job, worker->pool->outputMagic, &worker->reader, &worker->writer, worker->strip);
+            return;
+        }
+        slot->done += (size_t)result;
+        job->check = convertBatchSlot(worker, slot);
+        if (job->check != SUCCESS)
+            return;
+        slot->state = BATCH_SLOT_WRITING;
+        slot->done = 0;
+        queueBatchWrite(&worker->ring, slot->outputFile, slot->output, slot->outputSize, 0, tag);
+    }
+    else if (slot->state == BATCH_SLOT_WRITING)
+    {
+        if (result > 0 && slot->done + (size_t)result < slot->outputSize)
+        {
+            slot->done += (size_t)result;
+            queueBatchWrite(&worker->ring, slot->outputFile, slot->output + slot->done, slot->outputSize - slot->done, (off_t)slot->done, tag);
+            return;
+        }
+        if (result <= 0)
+            job->check = BAD_OUTPUT;
+        // the output block is finished with once it is written, and goes back on top of the spares
+        worker->spares[worker->spareCount] = slot->output;
+        worker->spareCapacities[worker->spareCount] = slot->outputCapacity;
+        worker->spareCount++;
+        slot->output = NULL;
+        slot->state = BATCH_SLOT_CLOSING;
+        queueBatchClose(&worker->ring, slot->outputFile, tag);
+    }
+    else
+    {
+        if (result < 0 && job->check == SUCCESS)
+            job->check = BAD_OUTPUT;
+        slot->state = BATCH_SLOT_FREE;
+    }
+}
+
+// This function writes the image a slot has converted to its output file with pwrite, from the start.
+// It returns BAD_OUTPUT when the image cannot all be written.
+static int rewriteBatchSlot(struct BatchSlot *slot)
+{
+    size_t done = 0;
+    while (done < slot->outputSize)
+    {
+        ssize_t written = pwrite(slot->outputFile, slot->output + done, slot->outputSize - done, (off_t)done);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return BAD_OUTPUT;
+        done += (size_t)written;
+    }
+    return SUCCESS;
+}
+
+// This function finishes the images on the go without the ring once its io_uring has failed, and returns 1
+// when the kernel is done with the worker's buffers. Whatever the kernel already has is waited for first, and
+// what it never got is then done here: an image still being read is converted again by runBatchJob, one being
+// written is written again with pwrite, and files whose close never reached the kernel are closed.
+// When even the waiting fails, the kernel may still be reading into the buffers or writing from the output
+// blocks, and a close it was given may or may not have happened, so those blocks and files are left to it.
+// Each worker has one ring a batch, so at most its buffers, BATCH_IO_SLOTS output blocks and two files a slot leak.
+static int windUpBatchSlots(struct BatchWorker *worker)
+{
+    uint64_t tag;
+    long result;
+    int drained;
+    while ((drained = drainBatchRing(&worker->ring, &tag, &result)) > 0)
+    {
+        struct BatchSlot *slot = &worker->slots[tag >> 1];
+        if (tag & BATCH_TAG_INPUT)
+            slot->inputClosing = 0;
+        // a read or write is done again whole below, so only a close finishes here
+        else if (slot->state == BATCH_SLOT_CLOSING)
+        {
+            if (result < 0 && slot->job->check == SUCCESS)
+                slot->job->check = BAD_OUTPUT;
+            slot->state = BATCH_SLOT_FREE;
+        }
+    }
+
+    for (int index = 0; index < BATCH_IO_SLOTS; index++)
+    {
+        struct BatchSlot *slot = &worker->slots[index];
+        struct BatchJob *job = slot->job;
+        if (slot->inputClosing && drained == 0)
+            close(slot->inputFile);
+        slot->inputClosing = 0;
+        if (slot->state == BATCH_SLOT_READING)
+        {
+            close(slot->inputFile);
+            runBatchJob(job, worker->pool->outputMagic, &worker->reader, &worker->writer, worker->strip);
+        }
+        else if (slot->state == BATCH_SLOT_WRITING)
+        {
+            job->check = rewriteBatchSlot(slot);
+            if (close(slot->outputFile) != 0 && job->check == SUCCESS)
+                job->check = BAD_OUTPUT;
+            if (drained == 0)
+            {
+                worker->spares[worker->spareCount] = slot->output;
+                worker->spareCapacities[worker->spareCount] = slot->outputCapacity;
+                worker->spareCount++;
+            }
+            slot->output = NULL;
+        }
+        else if (slot->state == BATCH_SLOT_CLOSING && drained == 0 && close(slot->outputFile) != 0 && job->check == SUCCESS)
+            job->check = BAD_OUTPUT;
+        slot->state = BATCH_SLOT_FREE;
+    }
+    return drained == 0;
+}
+
+// This function converts jobs until there are none left anywhere, keeping BATCH_IO_SLOTS small images on
+// the go at once. All of their reads are handed to the kernel together and each image is converted as soon
+// as its read finishes, while the others are still being read and the ones before it written, so the
+// worker is not left waiting on one file at a time. Reads go into buffers registered with the ring.
+// Large files, and every file when the buffers cannot be had, go through runBatchJob as before.
+// When the io_uring fails the images on the go are finished without it, and the jobs not yet taken are left
+// to runBatchJob. The worker's buffers are then left NULL if the kernel may still be using them.
+static void runBatchSlots(struct BatchWorker *worker)
+{
+    struct BatchPool *pool = worker->pool;
+    unsigned char *buffers = worker->buffers;
+    for (int slot = 0; slot < BATCH_IO_SLOTS && buffers != NULL; slot++)
+        worker->slots[slot].input = buffers + (size_t)slot * BATCH_IO_SLOT_BYTES;
+    setImageWriterMemory(&worker->writer, NULL, 0);
+
+    int more = 1;
+    for (;;)
+    {
+        // every free slot takes the next job, and the jobs a slot will not take are run here and now
+        for (int slot = 0; slot < BATCH_IO_SLOTS && more; slot++)
+        {
+            struct BatchSlot *next = &worker->slots[slot];
+            while (more && next->state == BATCH_SLOT_FREE && !next->inputClosing)
+            {
+                long job = takeBatchJob(pool, worker->index);
+                more = job >= 0;
+                if (more && (buffers == NULL || !startBatchSlot(worker, next, &pool->jobs[job], (uint64_t)slot << 1)))
+                    runBatchJob(&pool->jobs[job], pool->outputMagic, &worker->reader, &worker->writer, worker->strip);
+            }
+        }
+
+        uint64_t tag;
+        long result;
+        int waited = waitBatchRing(&worker->ring, &tag, &result);
+        if (waited < 0)
+            break;
+        if (waited == 0 && !more)
+            return;
+        if (waited == 0)
+            continue;
+        struct BatchSlot *slot = &worker->slots[tag >> 1];
+        if (tag & BATCH_TAG_INPUT)
+            slot->inputClosing = 0;
+        else
+            advanceBatchSlot(worker, slot, result, tag);
+    }
+
+    if (!windUpBatchSlots(worker))
+        worker->buffers = NULL;
+}
+
+// This function is the body of a worker thread, which converts jobs until there are none left anywhere.
+static void *runBatchWorker(void *argument)
+{
+    struct BatchWorker *worker = (struct BatchWorker *)argument;
+    struct BatchPool *pool = worker->pool;
+
+    initImageReader(&worker->reader);
+    initImageWriter(&worker->writer);
+    worker->strip = (unsigned char *)malloc(STREAM_STRIP_PIXELS);
+    memset(worker->slots, 0, sizeof(worker->slots));
+    worker->spareCount = 0;
+    worker->buffers = NULL;
+
+    if (pool->ioMode != BATCH_IO_STREAM && worker->strip != NULL)
+    {
+        worker->buffers = (unsigned char *)checkOutImageBlock(BATCH_IO_SLOTS * BATCH_IO_SLOT_BYTES, &worker->buffersCapacity);
+        openBatchRing(&worker->ring, pool->ioMode, worker->buffers, BATCH_IO_SLOTS * BATCH_IO_SLOT_BYTES);
+        runBatchSlots(worker);
+        closeBatchRing(&worker->ring);
+        returnImageBlock(worker->buffers, worker->buffersCapacity);
+    }
+    long job;
+    while ((job = takeBatchJob(pool, worker->index)) >= 0)
+        runBatchJob(&pool->jobs[job], pool->outputMagic, &worker->reader, &worker->writer, worker->strip);
+
+    for (int slot = 0; slot < BATCH_IO_SLOTS; slot++)
+        free(worker->slots[slot].output);
+    for (int spare = 0; spare < worker->spareCount; spare++)
+        free(worker->spares[spare]);
+    free(worker->strip);
+    freeImageReader(&worker->reader);
+    freeImageWriter(&worker->writer);
+    return NULL;
+}
+
+// This function converts every job of a batch to outputMagic with workerCount threads.
+// The jobs are dealt out as equal contiguous ranges, and a worker which runs out steals from the others,
+// so a few large images do not leave the rest of the pool idle.
+// It returns BAD_MALLOC when the pool cannot be set up, otherwise SUCCESS with each job's result filled in.
+int runBatch(struct BatchJob *jobs, long jobCount, unsigned short outputMagic, int workerCount)
+{
+    if (workerCount > jobCount)
+        workerCount = (int)jobCount;
+    if (workerCount < 1)
+        workerCount = 1;
+
+    struct BatchPool pool = {jobs, jobCount, outputMagic, NULL, workerCount, selectBatchIo()};
+    struct BatchWorker *workers = (struct BatchWorker *)malloc(workerCount * sizeof(struct BatchWorker));
+    if (workers == NULL || posix_memalign((void **)&pool.deques, 64, workerCount * sizeof(struct BatchDeque)) != 0)
+    {
+        free(workers);
+        return BAD_MALLOC;
+    }
+
+    for (int index = 0; index < workerCount; index++)
+    {
+        pool.deques[index].range = batchRange((uint32_t)(jobCount * index / workerCount), (uint32_t)(jobCount * (index + 1) / workerCount));
+        workers[index].pool = &pool;
+        workers[index].index = index;
+    }
+
+    // a worker which cannot be started leaves its jobs to be stolen by the others, or run here
+    for (int index = 1; index < workerCount; index++)
+        workers[index].running = pthread_create(&workers[index].thread, NULL, runBatchWorker, &workers[index]) == 0;
+    runBatchWorker(&workers[0]);
+    for (int index = 1; index < workerCount; index++)
+        if (workers[index].running)
+            pthread_join(workers[index].thread, NULL);
+
+    free(pool.deques);
+    free(workers);
+    return SUCCESS;
+}
+
+// This function returns 1 for the names of image files, which are the ones taken from an input directory.
+static int isImageFileName(const struct dirent *entry)
+{
+    const char *extension = strrchr(entry->d_name, '.');
+    return extension != NULL && (strcmp(extension, ".ebf") == 0 || strcmp(extension, ".ebu") == 0 || strcmp(extension, ".ebc") == 0 ||
+                                 strcmp(extension, ".ebt") == 0 || strcmp(extension, ".ebz") == 0);
+}
+
+// This function joins a directory and a file name into a malloced path.
+static char *joinBatchPath(const char *directory, const char *name, const char *extension)
+{
+    size_t length = strlen(directory) + strlen(name) + strlen(extension) + 2;
+    char *path = (char *)malloc(length);
+    if (path != NULL)
+        snprintf(path, length, "%s/%s%s", directory, name, extension);
+    return path;
+}
+
+// This function adds one input file to the list of jobs, growing it as needed.
+static int addBatchJob(struct BatchJob **jobs, long *jobCount, long *capacity, char *inputName)
+{
+    if (inputName == NULL)
+        return BAD_MALLOC;
+    if (*jobCount == *capacity)
+    {
+        long larger = *capacity == 0 ? 64 : *capacity * 2;
+        struct BatchJob *grown = (struct BatchJob *)realloc(*jobs, larger * sizeof(struct BatchJob));
+        if (grown == NULL)
+        {
+            free(inputName);
+            return BAD_MALLOC;
+        }
+        *jobs = grown;
+        *capacity = larger;
+    }
+    struct BatchJob *job = &(*jobs)[(*jobCount)++];
+    job->inputName = inputName;
+    job->outputName = NULL;
+    job->check = SUCCESS;
+    job->failedName = inputName;
+    return SUCCESS;
+}
+
+// This function lists the inputs of a batch, which are either the image files of a directory in name order
+// or the files named one per line in a manifest.
+// It returns BAD_FILE when inputs cannot be read, or BAD_MALLOC.
+static int listBatchInputs(const char *inputs, struct BatchJob **jobs, long *jobCount)
+{
+    long capacity = 0;
+    int check = SUCCESS;
+    *jobs = NULL;
+    *jobCount = 0;
+
+    struct stat inputsStatus;
+    if (stat(inputs, &inputsStatus) == 0 && S_ISDIR(inputsStatus.st_mode))
+    {
+        struct dirent **entries;
+        int entryCount = scandir(inputs, &entries, isImageFileName, alphasort);
+        if (entryCount < 0)
+            return BAD_FILE;
+        for (int entry = 0; entry < entryCount; entry++)
+        {
+            if (check == SUCCESS)
+                check = addBatchJob(jobs, jobCount, &capacity, joinBatchPath(inputs, entries[entry]->d_name, ""));
+            free(entries[entry]);
+        }
+        free(entries);
+        return check;
+    }
+
+    FILE *manifest = fopen(inputs, "r");
+    if (manifest == NULL)
+        return BAD_FILE;
+    char *line = NULL;
+    size_t lineSize = 0;
+    ssize_t length;
+    while (check == SUCCESS && (length = getline(&line, &lineSize, manifest)) >= 0)
+    {
+        // blank lines are skipped, and the line ending is not part of the name
+        while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r'))
+            line[--length] = '\0';
+        if (length > 0)
+            check = addBatchJob(jobs, jobCount, &capacity, strdup(line));
+    }
+    free(line);
+    fclose(manifest);
+    return check;
+}
+
+// This function orders jobs by output name, keeping input order between jobs with the same output.
+static int compareBatchOutputs(const void *first, const void *second)
+{
+    const struct BatchJob *job1 = *(const struct BatchJob *const *)first, *job2 = *(const struct BatchJob *const *)second;
+    int order = strcmp(job1->outputName, job2->outputName);
+    if (order != 0)
+        return order;
+    return job1 < job2 ? -1 : job1 > job2;
+}
+
+// This function names the output of every job after its input, in outputDirectory with the new extension.
+// Two inputs which differ only in extension would race to write the same file, so every one after the
+// first is failed with a bad output file name instead.
+static int nameBatchOutputs(struct BatchJob *jobs, long jobCount, const char *outputDirectory, const char *format)
+{
+    char extension[8];
+    snprintf(extension, sizeof(extension), ".%s", format);
+    for (long index = 0; index < jobCount; index++)
+    {
+        const char *slash = strrchr(jobs[index].inputName, '/');
+        char *stem = strdup(slash != NULL ? slash + 1 : jobs[index].inputName);
+        if (stem == NULL)
+            return BAD_MALLOC;
+        char *dot = strrchr(stem, '.');
+        if (dot != NULL && dot != stem)
+            *dot = '\0';
+        jobs[index].outputName = joinBatchPath(outputDirectory, stem, extension);
+        free(stem);
+        if (jobs[index].outputName == NULL)
+            return BAD_MALLOC;
+    }
+
+    struct BatchJob **byOutput = (struct BatchJob **)malloc((jobCount > 0 ? jobCount : 1) * sizeof(struct BatchJob *));
+    if (byOutput == NULL)
+        return BAD_MALLOC;
+    for (long index = 0; index < jobCount; index++)
+        byOutput[index] = &jobs[index];
+    qsort(byOutput, jobCount, sizeof(struct BatchJob *), compareBatchOutputs);
+    for (long index = 1; index < jobCount; index++)
+    {
+        if (strcmp(byOutput[index - 1]->outputName, byOutput[index]->outputName) == 0)
+        {
+            byOutput[index]->check = BAD_FILE;
+            byOutput[index]->failedName = byOutput[index]->outputName;
+        }
+    }
+    free(byOutput);
+    return SUCCESS;
+}
+
+// This function frees a list of jobs.
+static void freeBatchJobs(struct BatchJob *jobs, long jobCount)
+{
+    for (long index = 0; index < jobCount; index++)
+    {
+        free(jobs[index].inputName);
+        free(jobs[index].outputName);
+    }
+    free(jobs);
+}
+
+// This function converts a whole batch and prints one line per input, in input order, holding the input
+// name, the error code and the message the single file converters would print.
+// It returns the first error code of the batch, or SUCCESS when every file converted.
+int runBatchFiles(const char *inputs, const char *format, const char *outputDirectory, int workerCount)
+{
+    const struct ImageCodec *outputCodec = findImageCodecByName(format);
+    if (outputCodec == NULL)
+    {
+        printf("ERROR: Bad Arguments\n");
+        return BAD_ARGS;
+    }
+
+    struct stat outputStatus;
+    if (stat(outputDirectory, &outputStatus) != 0 || !S_ISDIR(outputStatus.st_mode))
+    {
+        reportImageError(BAD_FILE, outputDirectory);
+        return BAD_FILE;
+    }
+
+    struct BatchJob *jobs;
+    long jobCount;
+    int check = listBatchInputs(inputs, &jobs, &jobCount);
+    if (check == SUCCESS)
+        check = nameBatchOutputs(jobs, jobCount, outputDirectory, format);
+    if (check == SUCCESS)
+        check = runBatch(jobs, jobCount, outputCodec->magicNumber, workerCount);
+    if (check != SUCCESS)
+    {
+        freeBatchJobs(jobs, jobCount);
+        reportImageError(check, inputs);
+        return check;
+    }
+
+    for (long index = 0; index < jobCount; index++)
+    {
+        printf("%s\t%d\t", jobs[index].inputName, jobs[index].check);
+        if (jobs[index].check == SUCCESS)
+            printf("CONVERTED\n");
+        else
+            reportImageError(jobs[index].check, jobs[index].failedName);
+        if (check == SUCCESS)
+            check = jobs[index].check;
+    }
+    freeBatchJobs(jobs, jobCount);
+    return check;
+}
@@ -0,0 +1,19 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+// One input file of a batch and what became of it.
+typedef struct BatchJob
+{
+    char *inputName, *outputName;
+    // Error code of the conversion, and the file that error is about.
+    int check;
+    const char *failedName;
+} BatchJob;
+
+// This function converts every job of a batch to outputMagic with workerCount threads.
+int runBatch(struct BatchJob *jobs, long jobCount, unsigned short outputMagic, int workerCount);
+
+// This function converts every image listed by inputs to format in outputDirectory, printing one result line per input.
+int runBatchFiles(const char *inputs, const char *format, const char *outputDirectory, int workerCount);
+
+#endif
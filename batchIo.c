@@ -0,0 +1,281 @@
+// syscall and MAP_POPULATE are only declared for the default feature set
+#define _DEFAULT_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include "batchIo.h"
+
+// There is no liburing to lean on, so the ring is driven through its three system calls, which any
+// kernel with io_uring has. Without the header, or the calls, every ring falls back to pread and pwrite.
+#if defined(__linux__) && defined(__NR_io_uring_setup) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define BATCH_IO_HAS_URING
+#endif
+
+// This function returns how batch workers move their files: through an io_uring where the kernel has one.
+// BATCH_IO set to pread or stream picks one of the other ways.
+int selectBatchIo(void)
+{
+    const char *forced = getenv("BATCH_IO");
+    if (forced != NULL && strcmp(forced, "pread") == 0)
+        return BATCH_IO_PREAD;
+    if (forced != NULL && strcmp(forced, "stream") == 0)
+        return BATCH_IO_STREAM;
+    return BATCH_IO_URING;
+}
+
+#ifdef BATCH_IO_HAS_URING
+// This function returns 1 when the kernel behind a ring can carry out every operation a batch uses.
+// io_uring gained its operations over several releases, so one which is there may still lack some.
+static int probeBatchRing(int ringFile)
+{
+    const unsigned opCount = 256;
+    struct io_uring_probe *probe = (struct io_uring_probe *)calloc(1, sizeof(struct io_uring_probe) + opCount * sizeof(struct io_uring_probe_op));
+    if (probe == NULL)
+        return 0;
+    int usable = syscall(__NR_io_uring_register, ringFile, IORING_REGISTER_PROBE, probe, opCount) == 0;
+    const unsigned char ops[] = {IORING_OP_READ_FIXED, IORING_OP_READ, IORING_OP_WRITE, IORING_OP_CLOSE};
+    for (size_t index = 0; index < sizeof(ops) && usable; index++)
+        usable = ops[index] <= probe->last_op && (probe->ops[ops[index]].flags & IO_URING_OP_SUPPORTED);
+    free(probe);
+    return usable;
+}
+
+// This function sets up the io_uring of a ring and maps its shared rings.
+// It returns 0, leaving nothing behind, when the kernel does not have io_uring or will not give one.
+static int setUpBatchRing(struct BatchRing *ring)
+{
+    struct io_uring_params params;
+    // a ring used only by the thread which made it can leave the kernel's work on its completions until that
+    // thread asks for them, rather than interrupting it, on kernels which have the flags
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN;
+    int ringFile = (int)syscall(__NR_io_uring_setup, BATCH_IO_ENTRIES, &params);
+    if (ringFile < 0 && errno == EINVAL)
+    {
+        memset(&params, 0, sizeof(params));
+        ringFile = (int)syscall(__NR_io_uring_setup, BATCH_IO_ENTRIES, &params);
+    }
+    if (ringFile < 0)
+        return 0;
+
+    // both rings come from one mapping on any kernel recent enough to pass the probe
+    size_t sqLength = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    size_t cqLength = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->ringsLength = sqLength > cqLength ? sqLength : cqLength;
+    ring->sqesLength = params.sq_entries * sizeof(struct io_uring_sqe);
+    void *rings = MAP_FAILED, *sqes = MAP_FAILED;
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) && probeBatchRing(ringFile))
+    {
+        rings = mmap(NULL, ring->ringsLength, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFile, IORING_OFF_SQ_RING);
+        sqes = mmap(NULL, ring->sqesLength, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFile, IORING_OFF_SQES);
+    }
+    if (rings == MAP_FAILED || sqes == MAP_FAILED)
+    {
+        if (rings != MAP_FAILED)
+            munmap(rings, ring->ringsLength);
+        if (sqes != MAP_FAILED)
+            munmap(sqes, ring->sqesLength);
+        close(ringFile);
+        return 0;
+    }
+
+    unsigned char *base = (unsigned char *)rings;
+    ring->ringFile = ringFile;
+    ring->rings = rings;
+    ring->sqTail = (unsigned *)(base + params.sq_off.tail);
+    ring->sqMask = (unsigned *)(base + params.sq_off.ring_mask);
+    ring->sqArray = (unsigned *)(base + params.sq_off.array);
+    ring->cqHead = (unsigned *)(base + params.cq_off.head);
+    ring->cqTail = (unsigned *)(base + params.cq_off.tail);
+    ring->cqMask = (unsigned *)(base + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(base + params.cq_off.cqes);
+    ring->sqes = (struct io_uring_sqe *)sqes;
+
+    // pinning the buffers can fail against the locked memory limit, and reads then go through plain buffers
+    if (ring->buffers != NULL)
+    {
+        struct iovec vector = {ring->buffers, ring->buffersSize};
+        ring->registered = syscall(__NR_io_uring_register, ringFile, IORING_REGISTER_BUFFERS, &vector, 1) == 0;
+    }
+    return 1;
+}
+
+// This function fills in the next free entry of the submission ring.
+// Callers never have more than BATCH_IO_ENTRIES operations out, so there is always one.
+static void submitBatchEntry(struct BatchRing *ring, int op, int file, const unsigned char *bytes, size_t size, off_t offset, uint64_t tag)
+{
+    unsigned tail = *ring->sqTail, index = tail & *ring->sqMask;
+    struct io_uring_sqe *entry = &ring->sqes[index];
+    memset(entry, 0, sizeof(*entry));
+    entry->opcode = (unsigned char)op;
+    entry->fd = file;
+    entry->addr = (uint64_t)(uintptr_t)bytes;
+    entry->len = (unsigned)size;
+    entry->off = (uint64_t)offset;
+    entry->user_data = tag;
+    ring->sqArray[index] = index;
+    __atomic_store_n(ring->sqTail, tail + 1, __ATOMIC_RELEASE);
+    ring->queued++;
+    ring->inFlight++;
+}
+#endif
+
+// This function sets up a ring for mode, which is BATCH_IO_URING or BATCH_IO_PREAD.
+// Reads which land in buffers, of buffersSize bytes, go into pages registered with the kernel once rather
+// than pinned on every read. A ring which cannot have an io_uring carries out its operations with pread,
+// pwrite and close instead, and this function returns the mode the ring ended up with.
+int openBatchRing(struct BatchRing *ring, int mode, unsigned char *buffers, size_t buffersSize)
+{
+    memset(ring, 0, sizeof(*ring));
+    ring->ringFile = -1;
+    ring->buffers = buffers;
+    ring->buffersSize = buffersSize;
+#ifdef BATCH_IO_HAS_URING
+    if (mode == BATCH_IO_URING && setUpBatchRing(ring))
+        return BATCH_IO_URING;
+#endif
+    return BATCH_IO_PREAD;
+}
+
+// This function keeps the result of an operation carried out without an io_uring until it is collected.
+static void finishBatchEntry(struct BatchRing *ring, uint64_t tag, long result)
+{
+    struct BatchCompletion *completion = &ring->done[(ring->doneHead + ring->doneCount++) % BATCH_IO_ENTRIES];
+    completion->tag = tag;
+    completion->result = result;
+}
+
+// This function queues a read of size bytes at offset of a file into bytes.
+// Its result is the number of bytes read, which may be short, or minus the error number.
+void queueBatchRead(struct BatchRing *ring, int file, unsigned char *bytes, size_t size, off_t offset, uint64_t tag)
+{
+#ifdef BATCH_IO_HAS_URING
+    if (ring->ringFile >= 0)
+    {
+        int fixed = ring->registered && bytes >= ring->buffers && bytes + size <= ring->buffers + ring->buffersSize;
+        submitBatchEntry(ring, fixed ? IORING_OP_READ_FIXED : IORING_OP_READ, file, bytes, size, offset, tag);
+        return;
+    }
+#endif
+    ssize_t got;
+    while ((got = pread(file, bytes, size, offset)) < 0 && errno == EINTR)
+        ;
+    finishBatchEntry(ring, tag, got < 0 ? -errno : (long)got);
+}
+
+// This function queues a write of size bytes from bytes at offset of a file.
+// Its result is the number of bytes written, which may be short, or minus the error number.
+void queueBatchWrite(struct BatchRing *ring, int file, const unsigned char *bytes, size_t size, off_t offset, uint64_t tag)
+{
+#ifdef BATCH_IO_HAS_URING
+    if (ring->ringFile >= 0)
+    {
+        submitBatchEntry(ring, IORING_OP_WRITE, file, bytes, size, offset, tag);
+        return;
+    }
+#endif
+    ssize_t written;
+    while ((written = pwrite(file, bytes, size, offset)) < 0 && errno == EINTR)
+        ;
+    finishBatchEntry(ring, tag, written < 0 ? -errno : (long)written);
+}
+
+// This function queues the closing of a file. Its result is 0, or minus the error number.
+void queueBatchClose(struct BatchRing *ring, int file, uint64_t tag)
+{
+#ifdef BATCH_IO_HAS_URING
+    if (ring->ringFile >= 0)
+    {
+        submitBatchEntry(ring, IORING_OP_CLOSE, file, NULL, 0, 0, tag);
+        return;
+    }
+#endif
+    finishBatchEntry(ring, tag, close(file) != 0 ? -errno : 0);
+}
+
+#ifdef BATCH_IO_HAS_URING
+// This function takes the next entry off the completion ring, and returns 0 when there is none yet.
+static int takeBatchCompletion(struct BatchRing *ring, uint64_t *tag, long *result)
+{
+    unsigned head = *ring->cqHead;
+    if (head == __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE))
+        return 0;
+    struct io_uring_cqe *completion = &ring->cqes[head & *ring->cqMask];
+    *tag = completion->user_data;
+    *result = completion->res;
+    __atomic_store_n(ring->cqHead, head + 1, __ATOMIC_RELEASE);
+    ring->inFlight--;
+    return 1;
+}
+#endif
+
+// This function hands every queued operation to the kernel in one call and waits for one of them to finish,
+// setting tag to the tag it was queued with and result to its result. Operations finish in any order.
+// It returns 1, or 0 once nothing is left in flight, or -1 when the io_uring itself has failed.
+int waitBatchRing(struct BatchRing *ring, uint64_t *tag, long *result)
+{
+#ifdef BATCH_IO_HAS_URING
+    while (ring->ringFile >= 0 && ring->inFlight > 0)
+    {
+        if (takeBatchCompletion(ring, tag, result))
+            return 1;
+        long entered = syscall(__NR_io_uring_enter, ring->ringFile, ring->queued, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+        if (entered >= 0)
+            ring->queued -= (unsigned)entered;
+        else if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+            return -1;
+    }
+#endif
+    if (ring->doneCount == 0)
+        return 0;
+    *tag = ring->done[ring->doneHead].tag;
+    *result = ring->done[ring->doneHead].result;
+    ring->doneHead = (ring->doneHead + 1) % BATCH_IO_ENTRIES;
+    ring->doneCount--;
+    return 1;
+}
+
+// This function is waitBatchRing for a ring whose io_uring has failed. Nothing more is handed to the kernel:
+// the operations queued but never handed over are dropped, and will never be carried out or collected, and
+// this waits only for one of those the kernel already has. It returns 1, or 0 once the kernel has none left,
+// or -1 when even waiting fails, and the kernel may then still be using the buffers of those it has.
+int drainBatchRing(struct BatchRing *ring, uint64_t *tag, long *result)
+{
+#ifdef BATCH_IO_HAS_URING
+    if (ring->ringFile >= 0)
+    {
+        ring->inFlight -= ring->queued;
+        ring->queued = 0;
+    }
+    while (ring->ringFile >= 0 && ring->inFlight > 0)
+    {
+        if (takeBatchCompletion(ring, tag, result))
+            return 1;
+        if (syscall(__NR_io_uring_enter, ring->ringFile, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 &&
+            errno != EINTR && errno != EAGAIN && errno != EBUSY)
+            return -1;
+    }
+#endif
+    return waitBatchRing(ring, tag, result);
+}
+
+// This function tears a ring down once everything queued on it has been collected or drained, since the
+// kernel may still be reading into or writing from the buffers of an operation in flight.
+void closeBatchRing(struct BatchRing *ring)
+{
+#ifdef BATCH_IO_HAS_URING
+    if (ring->ringFile >= 0)
+    {
+        munmap(ring->sqes, ring->sqesLength);
+        munmap(ring->rings, ring->ringsLength);
+        close(ring->ringFile);
+    }
+#endif
+    ring->ringFile = -1;
+}
@@ -0,0 +1,76 @@
+#ifndef BATCH_IO_H
+#define BATCH_IO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+// How a batch worker moves its files: through an io_uring, with pread and pwrite when there is no
+// io_uring, or a strip at a time through the streaming converter.
+#define BATCH_IO_URING 0
+#define BATCH_IO_PREAD 1
+#define BATCH_IO_STREAM 2
+
+// Images a batch worker has on the go at once, and the largest image file read whole into one slot.
+// Larger files go through the streaming converter, which never holds a whole file.
+#define BATCH_IO_SLOTS 16
+#define BATCH_IO_SLOT_BYTES (1 << 16)
+
+// Operations a ring has queued or in flight at once: each slot has its input closing while its output
+// is written or closed.
+#define BATCH_IO_ENTRIES (2 * BATCH_IO_SLOTS)
+
+// One finished operation of a ring which has no io_uring.
+typedef struct BatchCompletion
+{
+    uint64_t tag;
+    long result;
+} BatchCompletion;
+
+// A queue of reads, writes and closes which the kernel carries out while the worker converts.
+// With an io_uring the operations go into its submission ring and come back through its completion ring.
+// Without one each operation is carried out as it is queued and its result kept until it is collected.
+typedef struct BatchRing
+{
+    int ringFile;
+    // the io_uring's shared rings, mapped from the kernel
+    unsigned *sqTail, *sqMask, *sqArray, *cqHead, *cqTail, *cqMask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *rings;
+    size_t ringsLength, sqesLength;
+    // operations not yet handed to the kernel, and queued but not yet collected
+    unsigned queued, inFlight;
+    // reads into this block are read straight into pages the kernel has already pinned
+    unsigned char *buffers;
+    size_t buffersSize;
+    int registered;
+    struct BatchCompletion done[BATCH_IO_ENTRIES];
+    unsigned doneHead, doneCount;
+} BatchRing;
+
+// This function returns how batch workers move their files, which BATCH_IO can force.
+int selectBatchIo(void);
+
+// This function sets up a ring for mode, with buffers registered for reads when it can be, and returns the mode it got.
+int openBatchRing(struct BatchRing *ring, int mode, unsigned char *buffers, size_t buffersSize);
+
+// This function queues a read of size bytes at offset of a file into bytes.
+void queueBatchRead(struct BatchRing *ring, int file, unsigned char *bytes, size_t size, off_t offset, uint64_t tag);
+
+// This function queues a write of size bytes from bytes at offset of a file.
+void queueBatchWrite(struct BatchRing *ring, int file, const unsigned char *bytes, size_t size, off_t offset, uint64_t tag);
+
+// This function queues the closing of a file.
+void queueBatchClose(struct BatchRing *ring, int file, uint64_t tag);
+
+// This function hands the queued operations over and waits for one to finish.
+int waitBatchRing(struct BatchRing *ring, uint64_t *tag, long *result);
+
+// This function waits for one of the operations the kernel already has after the io_uring has failed, dropping the rest.
+int drainBatchRing(struct BatchRing *ring, uint64_t *tag, long *result);
+
+// This function tears a ring down once everything queued on it has been collected or drained.
+void closeBatchRing(struct BatchRing *ring);
+
+#endif
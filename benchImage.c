@@ -0,0 +1,53 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include "benchImage.h"
+#include "imageStream.h"
+
+// This function fills a row with grey values from a xorshift generator.
+// The values are spread evenly over 0 to 31, so ebf text mixes one and two digit values and ebc data does not compress.
+void generateImageRow(uint32_t *state, unsigned char *row, int width)
+{
+    uint32_t x = *state;
+    for (int column = 0; column < width; column++)
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        row[column] = (unsigned char)(x >> 27);
+    }
+    *state = x;
+}
+
+// This function writes a synthetic image of the given format and size to fileName.
+// The same seed always gives the same pixels in every format, so generated files can be compared and converted
+// into each other. Only one row is held at a time, so the size of the image is limited only by the disk.
+// It returns SUCCESS or the error code of the writer, without printing anything.
+int generateImageFile(const char *fileName, unsigned short magicNumber, int height, int width, uint32_t seed)
+{
+    if (height < MIN_DIMENSION || width < MIN_DIMENSION || height > MAX_DIMENSION || width > MAX_DIMENSION)
+        return BAD_DIM;
+
+    unsigned char *row = (unsigned char *)malloc(width);
+    if (row == NULL)
+        return BAD_MALLOC;
+
+    struct ImageWriter writer;
+    initImageWriter(&writer);
+    int check = openImageWriter(&writer, fileName, magicNumber, height, width);
+    if (check == SUCCESS)
+    {
+        // a zero state would stay zero for ever
+        uint32_t state = seed != 0 ? seed : 0x9E3779B9u;
+        for (int line = 0; line < height && check == SUCCESS; line++)
+        {
+            generateImageRow(&state, row, width);
+            check = writeImagePixels(&writer, row, width);
+        }
+        int closed = closeImageWriter(&writer);
+        if (check == SUCCESS)
+            check = closed;
+    }
+    freeImageWriter(&writer);
+    free(row);
+    return check;
+}
@@ -0,0 +1,12 @@
+#ifndef BENCH_IMAGE_H
+#define BENCH_IMAGE_H
+
+#include <stdint.h>
+
+// This function fills a row with pseudo-random grey values, carrying the generator state from row to row.
+void generateImageRow(uint32_t *state, unsigned char *row, int width);
+
+// This function writes a synthetic image of the given format and size to fileName.
+int generateImageFile(const char *fileName, unsigned short magicNumber, int height, int width, uint32_t seed);
+
+#endif
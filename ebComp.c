@@ -0,0 +1,24 @@
+#include <stdio.h>
+#include "image.h"
+#include "streamComp.h"
+
+int main(int argc, char **argv)
+{
+    //main
+    if (argc == 1)
+    {
+        printf("Usage: ebComp file1 file2");
+        return SUCCESS;
+    } 
+    // validate that user has enter 2 arguments (plus the executable name) of any formats
+    // and optionally --hash or --cache before them to compare content hashes,
+    // or --stats to report how much the images differ
+    int mode = argc == 4 ? findCompareMode(argv[1]) : COMPARE_PIXELS;
+    if ((argc != 3 && argc != 4) || mode < 0) // check arg count 
+    { 
+        printf("ERROR: Bad Arguments\n");
+        return BAD_ARGS;
+    }
+
+    return compareImagesBy(argv[argc - 2], argv[argc - 1], 0, mode);    
+} // main()
@@ -0,0 +1,41 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "image.h"
+#include "batch.h"
+
+int main(int argc, char **argv)
+{
+    // main
+    if (argc == 1)
+    {
+        printf("Usage: ebbatch [-j threads] inputs format outputDirectory");
+        return SUCCESS;
+    }
+
+    // by default there is one worker for each processor
+    long workerCount = sysconf(_SC_NPROCESSORS_ONLN);
+    int first = 1;
+    if (argc == 6 && strcmp(argv[1], "-j") == 0)
+    {
+        char *end;
+        workerCount = strtol(argv[2], &end, 10);
+        if (*end != '\0' || workerCount < 1 || workerCount > 1024)
+        {
+            printf("ERROR: Bad Arguments\n");
+            return BAD_ARGS;
+        }
+        first = 3;
+    }
+    // validate that user has entered the inputs, the format and the output directory
+    if (argc - first != 3) // check arg count
+    {
+        printf("ERROR: Bad Arguments\n");
+        return BAD_ARGS;
+    }
+    if (workerCount < 1)
+        workerCount = 1;
+    return runBatchFiles(argv[first], argv[first + 1], argv[first + 2], (int)workerCount);
+
+} // main()
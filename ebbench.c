@@ -0,0 +1,250 @@
+// wait4 reports the peak memory of each child, and it is only declared for the default feature set
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include "image.h"
+#include "imageStream.h"
+#include "pixelCheck.h"
+#include "benchImage.h"
+
+// Every generated image uses the same seed, so the files of each format hold the same pixels.
+#define BENCH_SEED 1
+
+// One format of the benchmark and the files generated for it.
+typedef struct BenchFormat
+{
+    const char *name;
+    unsigned short magicNumber;
+    // Two copies of the same image, so that comparing reads both files to the end.
+    char first[4096], second[4096];
+} BenchFormat;
+
+// What an operation run inside a child process works on.
+typedef struct BenchTask
+{
+    const char *fileName;
+    unsigned short magicNumber;
+    int height, width;
+} BenchTask;
+
+// This function returns the current time in seconds.
+double benchSeconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// This function returns the size of a file in bytes, or 0 when it does not exist.
+long long benchFileSize(const char *fileName)
+{
+    struct stat fileStatus;
+    return stat(fileName, &fileStatus) == 0 ? (long long)fileStatus.st_size : 0;
+}
+
+// This function generates the image of a task.
+int generateBenchImage(const struct BenchTask *task)
+{
+    return generateImageFile(task->fileName, task->magicNumber, task->height, task->width, BENCH_SEED);
+}
+
+// This function reads every pixel of a task's image with a reader, checking the values as it goes.
+int readBenchImage(const struct BenchTask *task)
+{
+    struct ImageReader reader;
+    initImageReader(&reader);
+    unsigned char *chunk = (unsigned char *)malloc(STREAM_CHUNK_PIXELS);
+    int check = chunk == NULL ? BAD_MALLOC : openImageReader(&reader, task->fileName, task->magicNumber);
+    if (check == SUCCESS)
+    {
+        while (reader.pixelsLeft > 0 && check == SUCCESS)
+            check = readImagePixels(&reader, chunk, reader.pixelsLeft < STREAM_CHUNK_PIXELS ? reader.pixelsLeft : STREAM_CHUNK_PIXELS);
+        if (check == SUCCESS)
+            check = finishImageReader(&reader);
+        closeImageReader(&reader);
+    }
+    freeImageReader(&reader);
+    free(chunk);
+    return check;
+}
+
+// This function runs the range check over as many pixels as the image holds, a chunk at a time from memory,
+// so that the kernel is timed without any file access.
+int validateBenchImage(const struct BenchTask *task)
+{
+    unsigned char *chunk = (unsigned char *)malloc(STREAM_CHUNK_PIXELS);
+    if (chunk == NULL)
+        return BAD_MALLOC;
+    uint32_t state = BENCH_SEED;
+    generateImageRow(&state, chunk, (int)STREAM_CHUNK_PIXELS);
+
+    int check = SUCCESS;
+    for (long left = (long)task->height * task->width; left > 0 && check == SUCCESS; left -= STREAM_CHUNK_PIXELS)
+    {
+        long count = left < STREAM_CHUNK_PIXELS ? left : STREAM_CHUNK_PIXELS;
+        if (findBadPixel(chunk, count) != count)
+            check = BAD_DATA;
+    }
+    free(chunk);
+    return check;
+}
+
+// This function times one operation in a child process and prints its result as a line of JSON.
+// The operation is either an executable to run, or a function to call in the child.
+// Running it in its own process means the peak memory reported belongs to that operation alone.
+// A negative byte count means the size of the task's file once the operation has run, for operations which write it.
+// It returns the exit status of the operation.
+int runBenchOperation(const char *operation, const char *format, char *const *command,
+                      int (*function)(const struct BenchTask *), const struct BenchTask *task, long long bytes, long long pixels)
+{
+    fflush(stdout);
+    double start = benchSeconds();
+    pid_t child = fork();
+    if (child == 0)
+    {
+        // the tools print their results, which are not part of the benchmark output
+        int devNull = open("/dev/null", O_WRONLY);
+        if (devNull >= 0)
+            dup2(devNull, STDOUT_FILENO);
+        if (command != NULL)
+        {
+            execv(command[0], command);
+            _exit(BAD_FILE);
+        }
+        _exit(function(task));
+    }
+
+    int status = 0;
+    struct rusage usage;
+    memset(&usage, 0, sizeof(usage));
+    if (child < 0 || wait4(child, &status, 0, &usage) != child)
+        status = BAD_MALLOC << 8;
+    double seconds = benchSeconds() - start;
+    int code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    if (bytes < 0)
+        bytes = benchFileSize(task->fileName);
+
+    printf("{\"operation\":\"%s\",\"format\":\"%s\",\"height\":%d,\"width\":%d,\"pixels\":%lld,\"bytes\":%lld,"
+           "\"seconds\":%.6f,\"mb_per_s\":%.2f,\"pixels_per_s\":%.0f,\"peak_rss_kb\":%ld,\"status\":%d}\n",
+           operation, format, task->height, task->width, pixels, bytes,
+           seconds, bytes / seconds / 1e6, pixels / seconds, usage.ru_maxrss, code);
+    return code;
+}
+
+int main(int argc, char **argv)
+{
+    // main
+    if (argc == 1)
+    {
+        printf("Usage: ebbench height width directory");
+        return SUCCESS;
+    }
+    // validate that user has entered the size and a directory for the images
+    if (argc != 4) // check arg count
+    {
+        printf("ERROR: Bad Arguments\n");
+        return BAD_ARGS;
+    }
+    int height = atoi(argv[1]), width = atoi(argv[2]);
+    if (height < MIN_DIMENSION || width < MIN_DIMENSION || height > MAX_DIMENSION || width > MAX_DIMENSION)
+    {
+        printf("ERROR: Bad Dimensions (%s)\n", argv[3]);
+        return BAD_DIM;
+    }
+
+    struct BenchFormat formats[3] = {{"ebf", MAGIC_NUMBER_EBF}, {"ebu", MAGIC_NUMBER_EBU}, {"ebc", MAGIC_NUMBER_EBC}};
+    for (int index = 0; index < 3; index++)
+    {
+        snprintf(formats[index].first, sizeof(formats[index].first), "%s/bench.%s", argv[3], formats[index].name);
+        snprintf(formats[index].second, sizeof(formats[index].second), "%s/bench2.%s", argv[3], formats[index].name);
+    }
+    struct BenchFormat *ebf = &formats[0], *ebu = &formats[1], *ebc = &formats[2];
+    long long pixels = (long long)height * width;
+    char output[4096];
+    int check = SUCCESS, result;
+
+    // generating is timed too, and the second copy of each image is made the same way
+    for (int index = 0; index < 3; index++)
+    {
+        struct BenchTask task = {formats[index].first, formats[index].magicNumber, height, width};
+        result = runBenchOperation("generate", formats[index].name, NULL, generateBenchImage, &task, -1, pixels);
+        if (check == SUCCESS)
+            check = result;
+        result = generateImageFile(formats[index].second, formats[index].magicNumber, height, width, BENCH_SEED);
+        if (check == SUCCESS)
+            check = result;
+    }
+    if (check != SUCCESS)
+    {
+        reportImageError(check, argv[3]);
+        return check;
+    }
+
+    for (int index = 0; index < 3; index++)
+    {
+        struct BenchTask task = {formats[index].first, formats[index].magicNumber, height, width};
+        long long bytes = benchFileSize(formats[index].first);
+        result = runBenchOperation("read", formats[index].name, NULL, readBenchImage, &task, bytes, pixels);
+        if (check == SUCCESS)
+            check = result;
+    }
+
+    struct BenchTask validateTask = {ebu->first, MAGIC_NUMBER_EBU, height, width};
+    result = runBenchOperation("validate", "memory", NULL, validateBenchImage, &validateTask, pixels, pixels);
+    if (check == SUCCESS)
+        check = result;
+
+    // the tools themselves, so that everything between main and the disk is timed
+    struct
+    {
+        const char *operation, *executable;
+        struct BenchFormat *input, *output;
+    } tools[] = {
+        {"echo", "./ebfEcho", ebf, ebf},
+        {"echo", "./ebuEcho", ebu, ebu},
+        {"echo", "./ebcEcho", ebc, ebc},
+        {"compare", "./ebfComp", ebf, NULL},
+        {"compare", "./ebuComp", ebu, NULL},
+        {"compare", "./ebcComp", ebc, NULL},
+        {"ebf2ebu", "./ebf2ebu", ebf, ebu},
+        {"ebu2ebf", "./ebu2ebf", ebu, ebf},
+        {"ebu2ebc", "./ebu2ebc", ebu, ebc},
+        {"ebc2ebu", "./ebc2ebu", ebc, ebu},
+    };
+    for (size_t index = 0; index < sizeof(tools) / sizeof(tools[0]); index++)
+    {
+        struct BenchTask task = {tools[index].input->first, tools[index].input->magicNumber, height, width};
+        long long bytes = benchFileSize(tools[index].input->first);
+        char *command[4] = {(char *)tools[index].executable, tools[index].input->first, tools[index].input->second, NULL};
+        if (tools[index].output != NULL)
+        {
+            snprintf(output, sizeof(output), "%s/out.%s", argv[3], tools[index].output->name);
+            command[2] = output;
+            result = runBenchOperation(tools[index].operation, tools[index].input->name, command, NULL, &task, bytes, pixels);
+            unlink(output);
+        }
+        else
+        {
+            // comparing reads both copies
+            bytes += benchFileSize(tools[index].input->second);
+            result = runBenchOperation(tools[index].operation, tools[index].input->name, command, NULL, &task, bytes, pixels * 2);
+        }
+        if (check == SUCCESS)
+            check = result;
+    }
+
+    for (int index = 0; index < 3; index++)
+    {
+        unlink(formats[index].first);
+        unlink(formats[index].second);
+    }
+    return check;
+} // main()
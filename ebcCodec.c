@@ -0,0 +1,128 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "imageStream.h"
+#include "ebcPack.h"
+
+// This function checks the one whitespace separator before the packed data and sets up the unpacking blocks.
+static int startEbcReader(struct ImageReader *reader)
+{
+    int separator = getc(reader->inputFile);
+    if (reader->packed == NULL)
+        reader->packed = (unsigned char *)malloc(ebcPackedSize(ebcBlockPixels()));
+    if (reader->unpacked == NULL)
+        reader->unpacked = (unsigned char *)malloc(ebcBlockPixels());
+    if (reader->packed == NULL || reader->unpacked == NULL)
+        return BAD_MALLOC;
+    if (separator != ' ' && separator != '\n' && separator != '\r' && separator != '\t')
+        return BAD_DATA;
+    return SUCCESS;
+}
+
+// This function reads the packed data for the next count pixels, which must be at most one block,
+// and unpacks it into pixels.
+static int unpackEbcBlock(struct ImageReader *reader, unsigned char *pixels, long count)
+{
+    size_t size = (size_t)ebcPackedSize(count);
+    if (count <= 0 || fread(reader->packed, 1, size, reader->inputFile) != size)
+        return BAD_DATA;
+    unpackEbcPixels(reader->packed, count, pixels);
+    reader->packedPixelsLeft -= count;
+    return SUCCESS;
+}
+
+// This function hands out the next count pixels.
+// Whole blocks are unpacked straight into pixels. Only a block which is split between two calls
+// goes through the reader's own block, and then the rest of it is handed out from there.
+// Every block but the last holds a whole number of groups, so blocks unpack independently.
+static int readEbcPixels(struct ImageReader *reader, unsigned char *pixels, long count)
+{
+    long done = 0;
+    while (done < count)
+    {
+        long available = reader->unpackedCount - reader->unpackedPosition;
+        if (available > 0)
+        {
+            long take = count - done < available ? count - done : available;
+            memcpy(pixels + done, reader->unpacked + reader->unpackedPosition, take);
+            reader->unpackedPosition += take;
+            done += take;
+            continue;
+        }
+
+        long block = reader->packedPixelsLeft < ebcBlockPixels() ? reader->packedPixelsLeft : ebcBlockPixels();
+        if (count - done >= block)
+        {
+            if (unpackEbcBlock(reader, pixels + done, block) != SUCCESS)
+                return BAD_DATA;
+            done += block;
+        }
+        else
+        {
+            if (unpackEbcBlock(reader, reader->unpacked, block) != SUCCESS)
+                return BAD_DATA;
+            reader->unpackedPosition = 0;
+            reader->unpackedCount = block;
+        }
+    }
+    return SUCCESS;
+}
+
+// This function checks that the file ends with the last packed byte.
+static int finishEbcReader(struct ImageReader *reader)
+{
+    return getc(reader->inputFile) == EOF ? SUCCESS : BAD_DATA;
+}
+
+// This function sets up the block ebc pixels are gathered in.
+static int startEbcWriter(struct ImageWriter *writer)
+{
+    if (writer->pending == NULL)
+        writer->pending = (unsigned char *)malloc(ebcBlockPixels());
+    return writer->pending == NULL ? BAD_MALLOC : SUCCESS;
+}
+
+// This function packs the ebc pixels gathered so far into the buffer.
+static int packEbcWriter(struct ImageWriter *writer)
+{
+    size_t size = (size_t)ebcPackedSize(writer->pendingCount);
+    if (reserveImageWriter(writer, size) != SUCCESS)
+        return BAD_OUTPUT;
+    packEbcPixels(writer->pending, writer->pendingCount, writer->buffer + writer->buffered);
+    writer->buffered += size;
+    writer->pendingCount = 0;
+    return SUCCESS;
+}
+
+// This function gathers count pixels, packing each block as it fills.
+// Only whole blocks are packed before the end, so every block holds a whole number of groups.
+static int writeEbcPixels(struct ImageWriter *writer, const unsigned char *pixels, long count)
+{
+    int check = SUCCESS;
+    for (long done = 0; done < count && check == SUCCESS;)
+    {
+        long take = ebcBlockPixels() - writer->pendingCount;
+        if (take > count - done)
+            take = count - done;
+        memcpy(writer->pending + writer->pendingCount, pixels + done, take);
+        writer->pendingCount += take;
+        done += take;
+        if (writer->pendingCount == ebcBlockPixels())
+            check = packEbcWriter(writer);
+    }
+    writer->pixelsWritten += count;
+    return check;
+}
+
+// This function packs the last, partly filled block.
+static int finishEbcWriter(struct ImageWriter *writer)
+{
+    if (writer->pendingCount > 0)
+        return packEbcWriter(writer);
+    return SUCCESS;
+}
+
+const struct ImageCodec ebcCodec = {
+    "ebc", MAGIC_NUMBER_EBC,
+    startEbcReader, readEbcPixels, finishEbcReader,
+    startEbcWriter, writeEbcPixels, finishEbcWriter};
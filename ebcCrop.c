@@ -0,0 +1,64 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "image.h"
+#include "imageCodec.h"
+#include "imageStream.h"
+#include "ebcTile.h"
+
+// This function reads a whole number argument, returning 0 when it is not one.
+static int readCropArgument(const char *argument, int *value)
+{
+    char *end;
+    long number = strtol(argument, &end, 10);
+    if (*end != '\0' || end == argument || number < 0 || number > MAX_DIMENSION)
+        return 0;
+    *value = (int)number;
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    // main
+    if (argc == 1)
+    {
+        printf("Usage: ebcCrop file1 row column height width file2");
+        return SUCCESS;
+    }
+    // validate that user has entered the input, the rectangle and the output file
+    if (argc != 7) // check arg count
+    {
+        printf("ERROR: Bad Arguments\n");
+        return BAD_ARGS;
+    }
+
+    // the output format comes from the extension of the output file
+    int top, left, height, width;
+    const struct ImageCodec *outputCodec = findImageCodecByExtension(argv[6]);
+    if (outputCodec == NULL || !readCropArgument(argv[2], &top) || !readCropArgument(argv[3], &left) ||
+        !readCropArgument(argv[4], &height) || !readCropArgument(argv[5], &width))
+    {
+        printf("ERROR: Bad Arguments\n");
+        return BAD_ARGS;
+    }
+
+    struct ImageFileInfo crop;
+    initImageFileInfo(&crop);
+    int check = cropEbcImage(&crop, argv[1], top, left, height, width);
+    if (check != SUCCESS)
+    {
+        reportImageError(check, argv[1]);
+        return check;
+    }
+
+    check = writeImageFile(&crop, argv[6], outputCodec->magicNumber);
+    clearImageData(&crop);
+    if (check != SUCCESS)
+    {
+        reportImageError(check, argv[6]);
+        return check;
+    }
+
+    // print final success message and return
+    printf("CROPPED\n");
+    return SUCCESS;
+} // main()
@@ -0,0 +1,282 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "ebcPack.h"
+#include "imageKernel.h"
+#include "taskPool.h"
+
+#ifdef EBC_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+// This function packs count pixels one at a time. The bits after the last pixel are zero.
+void packEbcScalar(const unsigned char *pixels, long count, unsigned char *packed)
+{
+    long groups = count / EBC_GROUP_PIXELS;
+    for (long group = 0; group < groups; group++)
+    {
+        const unsigned char *p = pixels + group * EBC_GROUP_PIXELS;
+        uint64_t bits = 0;
+        for (int i = 0; i < EBC_GROUP_PIXELS; i++)
+            bits = (bits << 5) | (p[i] & 31);
+        unsigned char *out = packed + group * EBC_GROUP_BYTES;
+        for (int i = 0; i < EBC_GROUP_BYTES; i++)
+            out[i] = (unsigned char)(bits >> (32 - 8 * i));
+    }
+
+    // Pack the last partial group, padding the final byte with zero bits.
+    long done = groups * EBC_GROUP_PIXELS;
+    if (done < count)
+    {
+        uint64_t bits = 0;
+        for (int i = 0; i < EBC_GROUP_PIXELS; i++)
+            bits = (bits << 5) | (done + i < count ? (pixels[done + i] & 31) : 0);
+        unsigned char *out = packed + groups * EBC_GROUP_BYTES;
+        long tail = ebcPackedSize(count) - groups * EBC_GROUP_BYTES;
+        for (int i = 0; i < tail; i++)
+            out[i] = (unsigned char)(bits >> (32 - 8 * i));
+    }
+}
+
+// This function unpacks count pixels one group at a time.
+void unpackEbcScalar(const unsigned char *packed, long count, unsigned char *pixels)
+{
+    long groups = count / EBC_GROUP_PIXELS;
+    for (long group = 0; group < groups; group++)
+    {
+        const unsigned char *in = packed + group * EBC_GROUP_BYTES;
+        uint64_t bits = 0;
+        for (int i = 0; i < EBC_GROUP_BYTES; i++)
+            bits = (bits << 8) | in[i];
+        unsigned char *p = pixels + group * EBC_GROUP_PIXELS;
+        for (int i = 0; i < EBC_GROUP_PIXELS; i++)
+            p[i] = (unsigned char)((bits >> (35 - 5 * i)) & 31);
+    }
+
+    long done = groups * EBC_GROUP_PIXELS;
+    if (done < count)
+    {
+        const unsigned char *in = packed + groups * EBC_GROUP_BYTES;
+        long tail = ebcPackedSize(count) - groups * EBC_GROUP_BYTES;
+        uint64_t bits = 0;
+        for (int i = 0; i < EBC_GROUP_BYTES; i++)
+            bits = (bits << 8) | (i < tail ? in[i] : 0);
+        for (int i = 0; done + i < count; i++)
+            pixels[done + i] = (unsigned char)((bits >> (35 - 5 * i)) & 31);
+    }
+}
+
+#ifdef EBC_X86_KERNELS
+// This function packs 16 pixels at a time with SSE2.
+// Pixels are merged pairwise into 10, 20 and then 40 bit fields, so each 64-bit lane
+// ends up holding one group, which is then stored byte swapped.
+void packEbcSse2(const unsigned char *pixels, long count, unsigned char *packed)
+{
+    const __m128i lowBytes = _mm_set1_epi16(0x00FF);
+    const __m128i pairWeights = _mm_set1_epi32(0x00010400);
+    const __m128i lowWords = _mm_set1_epi64x(0xFFFFFFFF);
+
+    long done = 0;
+    // Each 8 byte store runs 3 bytes past its group, so stop while a later group can absorb it.
+    while (count - done >= 24)
+    {
+        __m128i p = _mm_and_si128(_mm_loadu_si128((const __m128i *)(pixels + done)), _mm_set1_epi8(31));
+        __m128i pairs = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(p, lowBytes), 5), _mm_srli_epi16(p, 8));
+        __m128i quads = _mm_madd_epi16(pairs, pairWeights);
+        __m128i groups = _mm_or_si128(_mm_slli_epi64(_mm_and_si128(quads, lowWords), 20), _mm_srli_epi64(quads, 32));
+
+        uint64_t lanes[2];
+        _mm_storeu_si128((__m128i *)lanes, groups);
+        unsigned char *out = packed + done / EBC_GROUP_PIXELS * EBC_GROUP_BYTES;
+        for (int i = 0; i < 2; i++)
+        {
+            uint64_t bytes = __builtin_bswap64(lanes[i] << 24);
+            memcpy(out + i * EBC_GROUP_BYTES, &bytes, sizeof(bytes));
+        }
+        done += 16;
+    }
+    packEbcScalar(pixels + done, count - done, packed + done / EBC_GROUP_PIXELS * EBC_GROUP_BYTES);
+}
+
+// This function unpacks 16 pixels at a time with SSE2, splitting the 40-bit groups in half three times.
+void unpackEbcSse2(const unsigned char *packed, long count, unsigned char *pixels)
+{
+    long done = 0;
+    // Each group is fetched with an 8 byte load, which must not run past the packed data.
+    while (count - done >= 24)
+    {
+        const unsigned char *in = packed + done / EBC_GROUP_PIXELS * EBC_GROUP_BYTES;
+        uint64_t first, second;
+        memcpy(&first, in, sizeof(first));
+        memcpy(&second, in + EBC_GROUP_BYTES, sizeof(second));
+        __m128i groups = _mm_set_epi64x((long long)(__builtin_bswap64(second) >> 24), (long long)(__builtin_bswap64(first) >> 24));
+
+        __m128i halves = _mm_or_si128(_mm_srli_epi64(groups, 20), _mm_slli_epi64(_mm_and_si128(groups, _mm_set1_epi64x(0xFFFFF)), 32));
+        __m128i quarters = _mm_or_si128(_mm_srli_epi32(halves, 10), _mm_slli_epi32(_mm_and_si128(halves, _mm_set1_epi32(0x3FF)), 16));
+        __m128i values = _mm_or_si128(_mm_srli_epi16(quarters, 5), _mm_slli_epi16(_mm_and_si128(quarters, _mm_set1_epi16(31)), 8));
+
+        _mm_storeu_si128((__m128i *)(pixels + done), values);
+        done += 16;
+    }
+    unpackEbcScalar(packed + done / EBC_GROUP_PIXELS * EBC_GROUP_BYTES, count - done, pixels + done);
+}
+
+// This function packs 32 pixels at a time with AVX2, using byte shuffles for the final swap.
+__attribute__((target("avx2"))) void packEbcAvx2(const unsigned char *pixels, long count, unsigned char *packed)
+{
+    const __m256i pixelWeights = _mm256_set1_epi16(0x0120);
+    const __m256i pairWeights = _mm256_set1_epi32(0x00010400);
+    const __m256i lowWords = _mm256_set1_epi64x(0xFFFFFFFF);
+    // Big endian bytes of the two 40-bit groups in each 128-bit lane, moved to the front.
+    const __m256i swap = _mm256_setr_epi8(4, 3, 2, 1, 0, 12, 11, 10, 9, 8, -1, -1, -1, -1, -1, -1,
+                                          4, 3, 2, 1, 0, 12, 11, 10, 9, 8, -1, -1, -1, -1, -1, -1);
+
+    long done = 0;
+    // Each 16 byte store runs 6 bytes past its lane, so leave room for a later group to absorb it.
+    while (count - done >= 48)
+    {
+        __m256i p = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(pixels + done)), _mm256_set1_epi8(31));
+        __m256i pairs = _mm256_maddubs_epi16(p, pixelWeights);
+        __m256i quads = _mm256_madd_epi16(pairs, pairWeights);
+        __m256i groups = _mm256_or_si256(_mm256_slli_epi64(_mm256_and_si256(quads, lowWords), 20), _mm256_srli_epi64(quads, 32));
+        __m256i bytes = _mm256_shuffle_epi8(groups, swap);
+
+        unsigned char *out = packed + done / EBC_GROUP_PIXELS * EBC_GROUP_BYTES;
+        _mm_storeu_si128((__m128i *)out, _mm256_castsi256_si128(bytes));
+        _mm_storeu_si128((__m128i *)(out + 2 * EBC_GROUP_BYTES), _mm256_extracti128_si256(bytes, 1));
+        done += 32;
+    }
+    packEbcSse2(pixels + done, count - done, packed + done / EBC_GROUP_PIXELS * EBC_GROUP_BYTES);
+}
+
+// This function unpacks 32 pixels at a time with AVX2.
+__attribute__((target("avx2"))) void unpackEbcAvx2(const unsigned char *packed, long count, unsigned char *pixels)
+{
+    // Turns the two big endian 40-bit groups at the start of each lane into little endian 64-bit lanes.
+    const __m256i swap = _mm256_setr_epi8(4, 3, 2, 1, 0, -1, -1, -1, 9, 8, 7, 6, 5, -1, -1, -1,
+                                          4, 3, 2, 1, 0, -1, -1, -1, 9, 8, 7, 6, 5, -1, -1, -1);
+
+    long done = 0;
+    // The 16 byte loads read 6 bytes past each lane, which must stay inside the packed data.
+    while (count - done >= 48)
+    {
+        const unsigned char *in = packed + done / EBC_GROUP_PIXELS * EBC_GROUP_BYTES;
+        __m256i raw = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)in)),
+                                              _mm_loadu_si128((const __m128i *)(in + 2 * EBC_GROUP_BYTES)), 1);
+        __m256i groups = _mm256_shuffle_epi8(raw, swap);
+
+        __m256i halves = _mm256_or_si256(_mm256_srli_epi64(groups, 20), _mm256_slli_epi64(_mm256_and_si256(groups, _mm256_set1_epi64x(0xFFFFF)), 32));
+        __m256i quarters = _mm256_or_si256(_mm256_srli_epi32(halves, 10), _mm256_slli_epi32(_mm256_and_si256(halves, _mm256_set1_epi32(0x3FF)), 16));
+        __m256i values = _mm256_or_si256(_mm256_srli_epi16(quarters, 5), _mm256_slli_epi16(_mm256_and_si256(quarters, _mm256_set1_epi16(31)), 8));
+
+        _mm256_storeu_si256((__m256i *)(pixels + done), values);
+        done += 32;
+    }
+    unpackEbcSse2(packed + done / EBC_GROUP_PIXELS * EBC_GROUP_BYTES, count - done, pixels + done);
+}
+#endif
+
+static EbcPackKernel ebcPackKernel = NULL;
+static EbcUnpackKernel ebcUnpackKernel = NULL;
+static pthread_once_t ebcKernelsOnce = PTHREAD_ONCE_INIT;
+
+// This function picks the fastest kernels the processor supports, or those EBC_KERNEL forces.
+static void pickEbcKernels(void)
+{
+    ebcPackKernel = packEbcScalar;
+    ebcUnpackKernel = unpackEbcScalar;
+#ifdef EBC_X86_KERNELS
+    const EbcPackKernel packKernels[] = {packEbcScalar, packEbcSse2, packEbcAvx2};
+    const EbcUnpackKernel unpackKernels[] = {unpackEbcScalar, unpackEbcSse2, unpackEbcAvx2};
+    int level = pickImageKernel("EBC_KERNEL");
+    ebcPackKernel = packKernels[level];
+    ebcUnpackKernel = unpackKernels[level];
+#endif
+}
+
+// This function picks the kernels the first time any thread calls it. Threads may call it at the same time,
+// and pthread_once makes each of them wait until the kernels are picked and see both of them.
+void selectEbcKernels(void)
+{
+    pthread_once(&ebcKernelsOnce, pickEbcKernels);
+}
+
+// This function returns the number of pixels the ebc reader and writer move in one block.
+// On one thread it is EBC_BLOCK_PIXELS, which stays in cache. With more it grows so that every pool
+// thread has two shares of at least EBC_PARALLEL_MIN_PIXELS in each block.
+long ebcBlockPixels(void)
+{
+    long pixels = 2 * EBC_PARALLEL_MIN_PIXELS * poolThreadCount();
+    return pixels > EBC_BLOCK_PIXELS ? pixels : EBC_BLOCK_PIXELS;
+}
+
+// A run of pixels cut into shares for the pool. Every share but the last is a whole number of groups,
+// so each one packs into its own bytes exactly as it would in one pass over the whole run.
+typedef struct EbcShares
+{
+    const unsigned char *pixels;
+    unsigned char *packed;
+    long count, share;
+} EbcShares;
+
+// This function cuts count pixels into shares of whole groups, one for each of shareCount threads.
+static struct EbcShares shareEbcPixels(long count, int shareCount)
+{
+    struct EbcShares shares;
+    shares.count = count;
+    shares.share = ((count + shareCount - 1) / shareCount + EBC_GROUP_PIXELS - 1) / EBC_GROUP_PIXELS * EBC_GROUP_PIXELS;
+    return shares;
+}
+
+// This function packs one share.
+static void packEbcShare(void *argument, long index)
+{
+    struct EbcShares *shares = (struct EbcShares *)argument;
+    long first = index * shares->share;
+    long count = shares->count - first < shares->share ? shares->count - first : shares->share;
+    ebcPackKernel(shares->pixels + first, count, shares->packed + first / EBC_GROUP_PIXELS * EBC_GROUP_BYTES);
+}
+
+// This function unpacks one share.
+static void unpackEbcShare(void *argument, long index)
+{
+    struct EbcShares *shares = (struct EbcShares *)argument;
+    long first = index * shares->share;
+    long count = shares->count - first < shares->share ? shares->count - first : shares->share;
+    ebcUnpackKernel(shares->packed + first / EBC_GROUP_PIXELS * EBC_GROUP_BYTES, count, (unsigned char *)shares->pixels + first);
+}
+
+// This function packs count pixels into ebcPackedSize(count) bytes.
+// A run long enough to keep several threads busy is cut into shares which are packed on the pool.
+// The output is the same byte for byte as packing the run in one pass.
+void packEbcPixels(const unsigned char *pixels, long count, unsigned char *packed)
+{
+    selectEbcKernels();
+    int shareCount = poolShareCount(count, EBC_PARALLEL_MIN_PIXELS);
+    if (shareCount <= 1)
+    {
+        ebcPackKernel(pixels, count, packed);
+        return;
+    }
+    struct EbcShares shares = shareEbcPixels(count, shareCount);
+    shares.pixels = pixels;
+    shares.packed = packed;
+    runPoolTasks(packEbcShare, &shares, (count + shares.share - 1) / shares.share);
+}
+
+// This function unpacks count pixels from ebcPackedSize(count) bytes, on the pool for a long run.
+void unpackEbcPixels(const unsigned char *packed, long count, unsigned char *pixels)
+{
+    selectEbcKernels();
+    int shareCount = poolShareCount(count, EBC_PARALLEL_MIN_PIXELS);
+    if (shareCount <= 1)
+    {
+        ebcUnpackKernel(packed, count, pixels);
+        return;
+    }
+    struct EbcShares shares = shareEbcPixels(count, shareCount);
+    shares.pixels = pixels;
+    shares.packed = (unsigned char *)packed;
+    runPoolTasks(unpackEbcShare, &shares, (count + shares.share - 1) / shares.share);
+}
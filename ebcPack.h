@@ -0,0 +1,54 @@
+#ifndef EBC_PACK_H
+#define EBC_PACK_H
+
+#include "image.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define EBC_X86_KERNELS 1
+#endif
+
+// Each pixel takes 5 bits, so every group of 8 pixels packs into exactly 5 bytes.
+// Bits are written most significant first, so the first pixel is the top 5 bits of the first byte.
+#define EBC_GROUP_PIXELS 8
+#define EBC_GROUP_BYTES 5
+
+// Number of pixels moved through the file in one read or write by a single thread.
+#define EBC_BLOCK_PIXELS (EBC_GROUP_PIXELS * 65536)
+
+// Fewest pixels worth packing or unpacking on a thread of their own.
+#define EBC_PARALLEL_MIN_PIXELS (1L << 18)
+
+// This function returns the number of bytes needed to pack count pixels.
+static inline long ebcPackedSize(long count)
+{
+    return (count * 5 + 7) / 8;
+}
+
+typedef void (*EbcPackKernel)(const unsigned char *pixels, long count, unsigned char *packed);
+typedef void (*EbcUnpackKernel)(const unsigned char *packed, long count, unsigned char *pixels);
+
+// These functions pack and unpack without a vector unit. The bits after the last pixel are zero.
+void packEbcScalar(const unsigned char *pixels, long count, unsigned char *packed);
+void unpackEbcScalar(const unsigned char *packed, long count, unsigned char *pixels);
+
+#ifdef EBC_X86_KERNELS
+// These functions do the same with SSE2 and AVX2. The AVX2 kernels must only run where the processor has it.
+void packEbcSse2(const unsigned char *pixels, long count, unsigned char *packed);
+void unpackEbcSse2(const unsigned char *packed, long count, unsigned char *pixels);
+void packEbcAvx2(const unsigned char *pixels, long count, unsigned char *packed);
+void unpackEbcAvx2(const unsigned char *packed, long count, unsigned char *pixels);
+#endif
+
+// This function returns the number of pixels the ebc reader and writer move in one block.
+long ebcBlockPixels(void);
+
+// This function picks the kernels packEbcPixels and unpackEbcPixels use, honouring EBC_KERNEL.
+void selectEbcKernels(void);
+
+// This function packs count pixels into ebcPackedSize(count) bytes, sharing a large run among the pool threads.
+void packEbcPixels(const unsigned char *pixels, long count, unsigned char *packed);
+
+// This function unpacks count pixels from ebcPackedSize(count) bytes, sharing a large run among the pool threads.
+void unpackEbcPixels(const unsigned char *packed, long count, unsigned char *pixels);
+
+#endif
@@ -0,0 +1,196 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "ebcTile.h"
+#include "ebcPack.h"
+
+// This function reads the tile size which follows the dimensions of a tiled ebc file, and the one
+// whitespace character separating it from the index. The size is parsed like the dimensions, so one
+// too long for an int is out of range rather than overflowing.
+// It returns BAD_DIM for a missing or out of range tile size and BAD_DATA for a missing separator.
+int readEbtTileSize(FILE *inputFile, int *tileSize)
+{
+    if (!readImageDimension(inputFile, tileSize) || *tileSize < 1 || *tileSize > EBT_MAX_TILE_SIZE)
+        return BAD_DIM;
+    int separator = getc(inputFile);
+    if (separator != ' ' && separator != '\n' && separator != '\r' && separator != '\t')
+        return BAD_DATA;
+    return SUCCESS;
+}
+
+// This function reads size bytes from offset in the file, carrying on after a partial read.
+// It returns BAD_DATA when the file ends first.
+static int readEbcBytesAt(int inputFile, unsigned char *bytes, size_t size, off_t offset)
+{
+    while (size > 0)
+    {
+        ssize_t got = pread(inputFile, bytes, size, offset);
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got <= 0)
+            return BAD_DATA;
+        bytes += got;
+        size -= (size_t)got;
+        offset += got;
+    }
+    return SUCCESS;
+}
+
+// This function fills the crop from a plain ebc file, reading only the groups each row of the crop touches.
+static int cropEbcRows(int inputFile, off_t dataStart, const struct ImageFileInfo *header, int top, int left, struct ImageFileInfo *crop)
+{
+    // a row of the crop can start part way through a group and end part way through another
+    long most = ((long)crop->width + 2 * EBC_GROUP_PIXELS) / EBC_GROUP_PIXELS * EBC_GROUP_PIXELS;
+    unsigned char *packed = (unsigned char *)malloc(ebcPackedSize(most));
+    unsigned char *unpacked = (unsigned char *)malloc(most);
+    int check = packed == NULL || unpacked == NULL ? BAD_MALLOC : SUCCESS;
+
+    for (long row = 0; row < crop->height && check == SUCCESS; row++)
+    {
+        long first = (top + row) * header->width + left;
+        long firstGroup = first / EBC_GROUP_PIXELS, endGroup = (first + crop->width + EBC_GROUP_PIXELS - 1) / EBC_GROUP_PIXELS;
+        long count = (endGroup - firstGroup) * EBC_GROUP_PIXELS;
+        if (count > header->numBytes - firstGroup * EBC_GROUP_PIXELS)
+            count = header->numBytes - firstGroup * EBC_GROUP_PIXELS;
+
+        check = readEbcBytesAt(inputFile, packed, (size_t)ebcPackedSize(count), dataStart + firstGroup * EBC_GROUP_BYTES);
+        if (check == SUCCESS)
+        {
+            unpackEbcPixels(packed, count, unpacked);
+            memcpy(imageRow(crop, row), unpacked + (first - firstGroup * EBC_GROUP_PIXELS), crop->width);
+        }
+    }
+
+    free(packed);
+    free(unpacked);
+    return check;
+}
+
+// This function fills the crop from a tiled ebc file, reading only the index entries and the tiles it overlaps.
+// The tiles a band contributes lie next to each other in the file, so each band takes two reads.
+static int cropEbtTiles(int inputFile, off_t indexStart, int tileSize, const struct ImageFileInfo *header, int top, int left, struct ImageFileInfo *crop)
+{
+    long across = ebtTileCount(header->width, tileSize), down = ebtTileCount(header->height, tileSize);
+    off_t dataStart = indexStart + (off_t)(across * down + 1) * EBT_INDEX_ENTRY_BYTES;
+    long firstColumn = left / tileSize, lastColumn = (left + crop->width - 1) / tileSize;
+    long firstRow = top / tileSize, lastRow = (top + crop->height - 1) / tileSize;
+    long columns = lastColumn - firstColumn + 1;
+
+    unsigned char *entries = (unsigned char *)malloc((columns + 1) * EBT_INDEX_ENTRY_BYTES);
+    unsigned char *packed = (unsigned char *)malloc(columns * ebcPackedSize((long)tileSize * tileSize));
+    unsigned char *tile = (unsigned char *)malloc((size_t)tileSize * tileSize);
+    int check = entries == NULL || packed == NULL || tile == NULL ? BAD_MALLOC : SUCCESS;
+
+    for (long tileRow = firstRow; tileRow <= lastRow && check == SUCCESS; tileRow++)
+    {
+        check = readEbcBytesAt(inputFile, entries, (columns + 1) * EBT_INDEX_ENTRY_BYTES, indexStart + (off_t)(tileRow * across + firstColumn) * EBT_INDEX_ENTRY_BYTES);
+        if (check != SUCCESS)
+            break;
+
+        // each tile must take exactly the bytes its pixels pack into, which also bounds the read below
+        int bandHeight = ebtTileExtent(header->height, tileSize, tileRow);
+        uint64_t start = loadEbtOffset(entries), end = start;
+        for (long column = 0; column < columns && check == SUCCESS; column++)
+        {
+            long count = (long)bandHeight * ebtTileExtent(header->width, tileSize, firstColumn + column);
+            end += (uint64_t)ebcPackedSize(count);
+            if (loadEbtOffset(entries + (column + 1) * EBT_INDEX_ENTRY_BYTES) != end)
+                check = BAD_DATA;
+        }
+        // an offset past the end of every tile could not be added to the position of the tiles
+        if (check == SUCCESS && start > (uint64_t)ebcPackedSize(header->numBytes))
+            check = BAD_DATA;
+        if (check == SUCCESS)
+            check = readEbcBytesAt(inputFile, packed, (size_t)(end - start), dataStart + (off_t)start);
+
+        // unpack each tile and copy the part of it inside the crop
+        const unsigned char *tilePacked = packed;
+        for (long column = firstColumn; column <= lastColumn && check == SUCCESS; column++)
+        {
+            int tileWidth = ebtTileExtent(header->width, tileSize, column);
+            long count = (long)bandHeight * tileWidth;
+            unpackEbcPixels(tilePacked, count, tile);
+            tilePacked += ebcPackedSize(count);
+
+            long fromRow = tileRow * tileSize < top ? top - tileRow * tileSize : 0;
+            long toRow = (tileRow * tileSize + bandHeight > top + crop->height ? top + crop->height - tileRow * tileSize : bandHeight);
+            long fromColumn = column * tileSize < left ? left - column * tileSize : 0;
+            long toColumn = (column * tileSize + tileWidth > left + crop->width ? left + crop->width - column * tileSize : tileWidth);
+            for (long row = fromRow; row < toRow; row++)
+                memcpy(imageRow(crop, tileRow * tileSize + row - top) + (column * tileSize + fromColumn - left),
+                       tile + row * tileWidth + fromColumn, toColumn - fromColumn);
+        }
+    }
+
+    free(entries);
+    free(packed);
+    free(tile);
+    return check;
+}
+
+// This function reads the rectangle height by width whose top left pixel is at row top and column left
+// of an ebc or tiled ebc file into crop, which is given a block of its own.
+// Only the header and the parts of the file the rectangle covers are read, so the time taken follows
+// the size of the rectangle rather than of the image: whole tiles for tiled ebc, and the packed
+// groups along each row for plain ebc. Neither file is checked beyond what is read.
+// It returns BAD_FILE, BAD_MAGIC_NUMBER, BAD_DIM for a bad header or a rectangle which is not inside
+// the image, BAD_MALLOC, or BAD_DATA when the file is cut short or its index is wrong.
+int cropEbcImage(struct ImageFileInfo *crop, const char *fileName, int top, int left, int height, int width)
+{
+    // open the input file in read mode
+    FILE *inputFile = fopen(fileName, "rb");
+    if (inputFile == NULL)
+        return BAD_FILE;
+
+    // the magic number says whether the file is tiled
+    unsigned short magicNumber = (unsigned short)getc(inputFile);
+    magicNumber |= (unsigned short)(getc(inputFile) << 8);
+    rewind(inputFile);
+    if (magicNumber != MAGIC_NUMBER_EBC && magicNumber != MAGIC_NUMBER_EBT)
+    {
+        fclose(inputFile);
+        return BAD_MAGIC_NUMBER;
+    }
+
+    struct ImageFileInfo header;
+    initImageFileInfo(&header);
+    int tileSize = 0;
+    int check = readImageHeader(inputFile, &header, magicNumber);
+    if (check == SUCCESS && magicNumber == MAGIC_NUMBER_EBT)
+        check = readEbtTileSize(inputFile, &tileSize);
+    else if (check == SUCCESS)
+    {
+        int separator = getc(inputFile);
+        if (separator != ' ' && separator != '\n' && separator != '\r' && separator != '\t')
+            check = BAD_DATA;
+    }
+
+    // the rectangle must lie inside the image
+    if (check == SUCCESS && (top < 0 || left < 0 || height < MIN_DIMENSION || width < MIN_DIMENSION ||
+                             top > header.height - height || left > header.width - width))
+        check = BAD_DIM;
+
+    if (check == SUCCESS)
+    {
+        crop->magicNumber[0] = header.magicNumber[0];
+        crop->magicNumber[1] = header.magicNumber[1];
+        crop->height = height;
+        crop->width = width;
+        check = allocateImageData(crop);
+    }
+    if (check == SUCCESS)
+    {
+        off_t dataStart = (off_t)ftell(inputFile);
+        if (tileSize > 0)
+            check = cropEbtTiles(fileno(inputFile), dataStart, tileSize, &header, top, left, crop);
+        else
+            check = cropEbcRows(fileno(inputFile), dataStart, &header, top, left, crop);
+        if (check != SUCCESS)
+            clearImageData(crop);
+    }
+
+    fclose(inputFile);
+    return check;
+}
@@ -0,0 +1,58 @@
+#ifndef EBC_TILE_H
+#define EBC_TILE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "image.h"
+
+// A tiled ebc file ("et") holds the same 5 bit pixels as ebc, cut into square tiles which are packed
+// independently so that any one of them can be unpacked on its own. After "et\nH W\n" comes the tile
+// size and one whitespace character, then an index of little endian 64 bit offsets, one per tile and
+// one past the last, counted from the end of the index. Tiles run along each band of tiles, band by
+// band, and the pixels of each tile are packed row by row as one run.
+
+// Side of the tiles the writer makes.
+#define EBT_TILE_SIZE 256
+
+// Largest tile side a reader accepts, so one tile always unpacks into a single ebc block.
+#define EBT_MAX_TILE_SIZE 512
+
+// Bytes in each entry of the tile index.
+#define EBT_INDEX_ENTRY_BYTES 8
+
+// This function returns the number of tiles needed to cover size pixels.
+static inline long ebtTileCount(int size, int tileSize)
+{
+    return (size + tileSize - 1) / tileSize;
+}
+
+// This function returns the number of pixels the tile at index covers along a side of size pixels.
+static inline int ebtTileExtent(int size, int tileSize, long index)
+{
+    long left = size - index * tileSize;
+    return left < tileSize ? (int)left : tileSize;
+}
+
+// This function stores an index entry, low byte first.
+static inline void storeEbtOffset(unsigned char *entry, uint64_t offset)
+{
+    for (int byte = 0; byte < EBT_INDEX_ENTRY_BYTES; byte++)
+        entry[byte] = (unsigned char)(offset >> (8 * byte));
+}
+
+// This function loads an index entry.
+static inline uint64_t loadEbtOffset(const unsigned char *entry)
+{
+    uint64_t offset = 0;
+    for (int byte = EBT_INDEX_ENTRY_BYTES - 1; byte >= 0; byte--)
+        offset = offset << 8 | entry[byte];
+    return offset;
+}
+
+// This function reads the tile size which follows the dimensions, and the separator after it.
+int readEbtTileSize(FILE *inputFile, int *tileSize);
+
+// This function reads the rectangle of an ebc or tiled ebc file given by its top left pixel and size.
+int cropEbcImage(struct ImageFileInfo *crop, const char *fileName, int top, int left, int height, int width);
+
+#endif
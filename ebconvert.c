@@ -0,0 +1,21 @@
+#include <stdio.h>
+#include "image.h"
+#include "streamConvert.h"
+
+int main(int argc, char **argv)
+{
+    // main
+    if (argc == 1)
+    {
+        printf("Usage: ebconvert file1 file2");
+        return SUCCESS;
+    }
+    // validate that user has enter 2 arguments (plus the executable name)
+    if (argc != 3) // check arg count
+    {
+        printf("ERROR: Bad Arguments\n");
+        return BAD_ARGS;
+    }
+    return transcodeImageFile(argv[1], argv[2]);
+
+} // main()
@@ -0,0 +1,24 @@
+#include <stdio.h>
+#include "image.h"
+#include "imageDaemon.h"
+
+int main(int argc, char **argv)
+{
+    // main
+    if (argc == 1)
+    {
+        printf("Usage: ebd socket");
+        return SUCCESS;
+    }
+    // validate that user has entered the path of the socket to listen on
+    if (argc != 2) // check arg count
+    {
+        printf("ERROR: Bad Arguments\n");
+        return BAD_ARGS;
+    }
+
+    // only returns when the socket cannot be made or stops accepting
+    int check = serveImageDaemon(argv[1]);
+    reportImageError(check, argv[1]);
+    return check;
+} // main()
@@ -0,0 +1,21 @@
+#include <stdio.h>
+#include "image.h"
+#include "imageDaemon.h"
+
+int main(int argc, char **argv)
+{
+    // main
+    if (argc == 1)
+    {
+        printf("Usage: ebdc socket tool [arguments]");
+        return SUCCESS;
+    }
+    // validate that user has entered the socket of the daemon and the tool to run,
+    // whose own arguments are checked by the daemon just as the tool would check them
+    if (argc < 3) // check arg count
+    {
+        printf("ERROR: Bad Arguments\n");
+        return BAD_ARGS;
+    }
+    return requestImageDaemon(argv[1], argc - 2, argv + 2);
+} // main()
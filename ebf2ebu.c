@@ -1,4 +1,6 @@
-#include "ebfConvert.h"
+#include <stdio.h>
+#include "image.h"
+#include "streamConvert.h"
 
 int main(int argc, char **argv)
 {
@@ -14,6 +16,6 @@ int main(int argc, char **argv)
         printf("ERROR: Bad Arguments\n");
         return BAD_ARGS;
     }
-    return run(argc, argv);
+    return convertImageFile(argv[1], MAGIC_NUMBER_EBF, argv[2], MAGIC_NUMBER_EBU);
     
 } // main()
\ No newline at end of file
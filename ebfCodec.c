@@ -0,0 +1,95 @@
+#include <stdlib.h>
+#include <string.h>
+#include "imageStream.h"
+#include "ebfParse.h"
+
+// Longest text one ebf value can produce: two digits and a separator, rounded up for a 4 byte copy.
+#define EBF_TEXT_WIDTH 4
+
+// Text of every grey value followed by a space, and how many of those bytes are used.
+static const char ebfValueText[32][EBF_TEXT_WIDTH] = {
+    "0 ", "1 ", "2 ", "3 ", "4 ", "5 ", "6 ", "7 ", "8 ", "9 ", "10 ", "11 ", "12 ", "13 ", "14 ", "15 ",
+    "16 ", "17 ", "18 ", "19 ", "20 ", "21 ", "22 ", "23 ", "24 ", "25 ", "26 ", "27 ", "28 ", "29 ", "30 ", "31 "};
+static const unsigned char ebfValueLength[32] = {
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3};
+
+// This function hands the text after the header to a block parser.
+static int startEbfReader(struct ImageReader *reader)
+{
+    if (reader->parseBlock == NULL)
+        reader->parseBlock = (unsigned char *)malloc(EBF_BLOCK_SIZE);
+    if (reader->parseBlock == NULL)
+        return BAD_MALLOC;
+    startEbfParser(&reader->ebfParser, reader->inputFile, reader->parseBlock);
+    return SUCCESS;
+}
+
+// This function parses the next count grey values.
+static int readEbfReaderPixels(struct ImageReader *reader, unsigned char *pixels, long count)
+{
+    return parseEbfPixels(&reader->ebfParser, pixels, count);
+}
+
+// This function checks that only whitespace follows the last grey value.
+static int finishEbfReader(struct ImageReader *reader)
+{
+    return finishEbfParser(&reader->ebfParser);
+}
+
+// The ebf writer needs no block beyond the shared buffer.
+static int startEbfWriter(struct ImageWriter *writer)
+{
+    return SUCCESS;
+}
+
+// This function formats count grey values as ebf text into the buffer.
+// Each value is copied whole from the table, and only the separators at row ends are fixed up.
+static int writeEbfPixels(struct ImageWriter *writer, const unsigned char *pixels, long count)
+{
+    long done = 0;
+    while (done < count)
+    {
+        // the rest of the current row, or as much of it as the buffer can hold
+        long column = writer->pixelsWritten % writer->width;
+        long take = writer->width - column;
+        if (take > count - done)
+            take = count - done;
+        long room = (long)(IMAGE_WRITE_BUFFER - writer->buffered) / EBF_TEXT_WIDTH;
+        if (room < take)
+        {
+            if (flushImageWriter(writer) != SUCCESS)
+                return BAD_OUTPUT;
+            continue;
+        }
+
+        unsigned char *out = writer->buffer + writer->buffered;
+        for (long i = 0; i < take; i++)
+        {
+            // the readers only hand out values from 0 to 31, the mask just keeps the lookup in bounds
+            unsigned int value = pixels[done + i] & 31;
+            memcpy(out, ebfValueText[value], EBF_TEXT_WIDTH);
+            out += ebfValueLength[value];
+        }
+        done += take;
+        writer->pixelsWritten += take;
+
+        // a row ends in a newline instead of a space, and the last value has nothing after it
+        if (writer->pixelsWritten == writer->numBytes)
+            out--;
+        else if (writer->pixelsWritten % writer->width == 0)
+            out[-1] = '\n';
+        writer->buffered = (size_t)(out - writer->buffer);
+    }
+    return SUCCESS;
+}
+
+// Every value is in the buffer as soon as it is written.
+static int finishEbfWriter(struct ImageWriter *writer)
+{
+    return SUCCESS;
+}
+
+const struct ImageCodec ebfCodec = {
+    "ebf", MAGIC_NUMBER_EBF,
+    startEbfReader, readEbfReaderPixels, finishEbfReader,
+    startEbfWriter, writeEbfPixels, finishEbfWriter};
@@ -0,0 +1,140 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ebfParallel.h"
+#include "ebfParse.h"
+#include "taskPool.h"
+
+// One piece of the payload, the pixels it fills and how parsing it went.
+typedef struct EbfChunk
+{
+    const unsigned char *text;
+    size_t length;
+    unsigned char *pixels;
+    long count;
+    int check;
+} EbfChunk;
+
+// This function counts the grey values in one chunk.
+static void countEbfChunk(void *argument, long index)
+{
+    struct EbfChunk *chunk = (struct EbfChunk *)argument + index;
+    chunk->count = countEbfValues(chunk->text, chunk->length);
+}
+
+// This function parses one chunk into its own pixels, which nothing else writes to.
+// The chunk must hold exactly count values followed by nothing but whitespace.
+static void parseEbfChunk(void *argument, long index)
+{
+    struct EbfChunk *chunk = (struct EbfChunk *)argument + index;
+    struct EbfParser parser;
+    startEbfTextParser(&parser, chunk->text, chunk->length);
+    chunk->check = parseEbfPixels(&parser, chunk->pixels, chunk->count);
+    if (chunk->check == SUCCESS)
+        chunk->check = finishEbfParser(&parser);
+}
+
+// This function parses the ebf text of a whole payload into count pixels as threadCount chunks on the pool.
+// The text is cut into one chunk per thread, each cut moved on past any number it falls inside so that
+// every number lies wholly in one chunk. The values in each chunk are counted at the same time, and a
+// running total of the counts gives the pixel each chunk starts at, so the chunks can then be parsed
+// at the same time straight into their places.
+// It returns SUCCESS or BAD_DATA, for the wrong number of values, a value above 31 or a stray character.
+int parseEbfText(const unsigned char *text, size_t length, unsigned char *pixels, long count, int threadCount)
+{
+    if ((long)(length / EBF_PARALLEL_MIN_BYTES) < threadCount)
+        threadCount = (int)(length / EBF_PARALLEL_MIN_BYTES);
+    if (threadCount > EBF_PARALLEL_MAX_THREADS)
+        threadCount = EBF_PARALLEL_MAX_THREADS;
+    if (threadCount < 1)
+        threadCount = 1;
+
+    struct EbfChunk chunks[EBF_PARALLEL_MAX_THREADS];
+    size_t start = 0;
+    for (int index = 0; index < threadCount; index++)
+    {
+        size_t end = index == threadCount - 1 ? length : length / threadCount * (index + 1);
+        if (end < start)
+            end = start;
+        while (end < length && (unsigned char)(text[end] - '0') < 10)
+            end++;
+        chunks[index].text = text + start;
+        chunks[index].length = end - start;
+        start = end;
+    }
+
+    // one chunk already knows how many values it should hold
+    chunks[0].count = count;
+    if (threadCount > 1)
+    {
+        runPoolTasks(countEbfChunk, chunks, threadCount);
+        long total = 0;
+        for (int index = 0; index < threadCount; index++)
+            total += chunks[index].count;
+        if (total != count)
+            return BAD_DATA;
+    }
+
+    long first = 0;
+    for (int index = 0; index < threadCount; index++)
+    {
+        chunks[index].pixels = pixels + first;
+        first += chunks[index].count;
+    }
+    runPoolTasks(parseEbfChunk, chunks, threadCount);
+    for (int index = 0; index < threadCount; index++)
+        if (chunks[index].check != SUCCESS)
+            return chunks[index].check;
+    return SUCCESS;
+}
+
+// This function reads an ebf file into a block of its own.
+// The header is read as usual. A payload large enough to be worth splitting is then mapped and
+// parsed on every thread of the pool, see parseEbfText, and anything else is parsed as it is read.
+// Nothing is printed, the error code is returned for the caller to report.
+int readEbfImage(struct ImageFileInfo *imageFileInfo, const char *fileName)
+{
+    // open the input file in read mode
+    FILE *inputFile = fopen(fileName, "rb");
+    if (inputFile == NULL)
+        return BAD_FILE;
+
+    int check = readImageHeader(inputFile, imageFileInfo, MAGIC_NUMBER_EBF);
+    if (check == SUCCESS)
+        check = allocateImageData(imageFileInfo);
+    if (check != SUCCESS)
+    {
+        fclose(inputFile);
+        return check;
+    }
+
+    // the payload starts straight after the width, which is where the header left the file
+    int threadCount = poolThreadCount();
+    long payloadStart = ftell(inputFile);
+    struct stat fileStatus;
+    void *mapping = MAP_FAILED;
+    size_t mappingLength = 0;
+    if (threadCount > 1 && payloadStart >= 0 && fstat(fileno(inputFile), &fileStatus) == 0 && S_ISREG(fileStatus.st_mode) &&
+        fileStatus.st_size - payloadStart >= 2 * EBF_PARALLEL_MIN_BYTES)
+    {
+        mappingLength = (size_t)fileStatus.st_size;
+        mapping = mmap(NULL, mappingLength, PROT_READ, MAP_PRIVATE, fileno(inputFile), 0);
+    }
+
+    if (mapping != MAP_FAILED)
+    {
+        // every chunk is read at once, so ask for the whole file rather than reading ahead of one place
+        posix_madvise(mapping, mappingLength, POSIX_MADV_WILLNEED);
+        check = parseEbfText((const unsigned char *)mapping + payloadStart, mappingLength - (size_t)payloadStart,
+                             imageFileInfo->imageData, imageFileInfo->numBytes, threadCount);
+        munmap(mapping, mappingLength);
+    }
+    else
+        check = readEbfPixels(inputFile, imageFileInfo);
+
+    if (check != SUCCESS)
+        clearImageData(imageFileInfo);
+    fclose(inputFile);
+    return check;
+}
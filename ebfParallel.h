@@ -0,0 +1,19 @@
+#ifndef EBF_PARALLEL_H
+#define EBF_PARALLEL_H
+
+#include <stddef.h>
+#include "image.h"
+
+// Least text each thread is given, so small files are not split among threads which would cost more than they save.
+#define EBF_PARALLEL_MIN_BYTES (1L << 22)
+
+// Most threads one payload is split among.
+#define EBF_PARALLEL_MAX_THREADS 64
+
+// This function parses the ebf text of a whole payload into pixels as up to threadCount chunks on the pool.
+int parseEbfText(const unsigned char *text, size_t length, unsigned char *pixels, long count, int threadCount);
+
+// This function reads an ebf file, parsing a large payload on several threads at once.
+int readEbfImage(struct ImageFileInfo *imageFileInfo, const char *fileName);
+
+#endif
@@ -0,0 +1,257 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "ebfParse.h"
+#include "pixelCheck.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// This function tells whether c is one of the whitespace characters that fscanf skips.
+static inline int isEbfSpace(unsigned char c)
+{
+    return c == ' ' || (unsigned char)(c - '\t') <= '\r' - '\t';
+}
+
+// This function prepares a parser to read grey values from the current position of inputFile,
+// using a block of EBF_BLOCK_SIZE bytes which belongs to the caller.
+void startEbfParser(struct EbfParser *parser, FILE *inputFile, unsigned char *buffer)
+{
+    parser->inputFile = inputFile;
+    parser->buffer = buffer;
+    parser->length = parser->position = 0;
+    parser->value = 0;
+    parser->inToken = 0;
+    parser->endOfFile = 0;
+}
+
+// This function prepares a parser to read grey values from text which is already in memory,
+// a mapped file for example. The text is never written to, and the parser ends where the text does.
+void startEbfTextParser(struct EbfParser *parser, const unsigned char *text, size_t length)
+{
+    startEbfParser(parser, NULL, (unsigned char *)text);
+    parser->length = length;
+    parser->endOfFile = 1;
+}
+
+// This function prepares a parser with a block of its own, to be freed with freeEbfParser.
+int initEbfParser(struct EbfParser *parser, FILE *inputFile)
+{
+    startEbfParser(parser, inputFile, (unsigned char *)malloc(EBF_BLOCK_SIZE));
+    if (parser->buffer == NULL)
+        return BAD_MALLOC;
+    return SUCCESS;
+}
+
+// This function frees the parser block.
+void freeEbfParser(struct EbfParser *parser)
+{
+    free(parser->buffer);
+    parser->buffer = NULL;
+}
+
+// This function reads the next block of the file, returning 0 once nothing is left.
+static int refillEbfParser(struct EbfParser *parser)
+{
+    if (parser->endOfFile)
+        return 0;
+
+    parser->length = fread(parser->buffer, 1, EBF_BLOCK_SIZE, parser->inputFile);
+    parser->position = 0;
+    if (parser->length < EBF_BLOCK_SIZE)
+        parser->endOfFile = 1;
+    return parser->length > 0;
+}
+
+// This function scans one byte, storing a finished value into pixels.
+// It returns BAD_DATA for a character which cannot appear in an ebf payload.
+// Values above 31 are stored as they are, to be caught by the range check afterwards.
+static inline int scanEbfByte(struct EbfParser *parser, unsigned char c, unsigned char *pixels, long *written)
+{
+    unsigned int digit = (unsigned int)(c - '0');
+    if (digit < 10)
+    {
+        unsigned int value = parser->value * 10 + digit;
+        parser->value = value > EBF_VALUE_LIMIT ? EBF_VALUE_LIMIT : value;
+        parser->inToken = 1;
+        return SUCCESS;
+    }
+    if (!isEbfSpace(c))
+        return BAD_DATA;
+
+    if (parser->inToken)
+    {
+        pixels[(*written)++] = (unsigned char)parser->value;
+        parser->value = 0;
+        parser->inToken = 0;
+    }
+    return SUCCESS;
+}
+
+#if defined(__SSE2__)
+// This function parses every number which ends inside the 16 bytes at block.
+// One vector compare finds the digits, the one and two digit values for every byte are formed
+// in parallel, and then only the bytes where a number starts are stored.
+// It must be called between numbers. It returns -1 when the block needs the scalar scanner:
+// unusual characters, a number with three or more digits, or more numbers than are still wanted.
+static inline int scanEbfBlock16(const unsigned char *block, unsigned char *pixels, long *written, long count, int *consumed)
+{
+    __m128i bytes = _mm_loadu_si128((const __m128i *)block);
+    // Bytes from '0' to '9' become 0..9 and everything else lands above 9 as unsigned.
+    __m128i digits = _mm_sub_epi8(bytes, _mm_set1_epi8('0'));
+    __m128i digitTest = _mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+    __m128i spaceTest = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n'))),
+                                     _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\t'))));
+
+    unsigned int digitMask = (unsigned int)_mm_movemask_epi8(digitTest);
+    unsigned int spaceMask = (unsigned int)_mm_movemask_epi8(spaceTest);
+    if ((digitMask | spaceMask) != 0xFFFF || (digitMask & (digitMask >> 1) & (digitMask >> 2)) != 0)
+        return -1;
+
+    // A number is complete when its last digit is followed by whitespace inside the block.
+    unsigned int ends = digitMask & (spaceMask >> 1);
+    unsigned int starts = digitMask & ~(digitMask << 1);
+    if (ends == 0)
+    {
+        // Skip the whitespace and stop at any number which runs past the end of the block.
+        *consumed = digitMask == 0 ? 16 : __builtin_ctz(digitMask);
+        return *consumed == 0 ? -1 : SUCCESS;
+    }
+    int lastEnd = 31 - __builtin_clz(ends);
+    starts &= (2u << lastEnd) - 1;
+    if (__builtin_popcount(starts) > count - *written)
+        return -1;
+
+    // value = digit where the next byte is whitespace, otherwise 10 * digit + next digit.
+    __m128i next = _mm_srli_si128(digits, 1);
+    __m128i nextIsDigit = _mm_srli_si128(digitTest, 1);
+    __m128i twice = _mm_add_epi8(digits, digits);
+    __m128i eight = _mm_add_epi8(_mm_add_epi8(twice, twice), _mm_add_epi8(twice, twice));
+    __m128i pair = _mm_add_epi8(_mm_add_epi8(eight, twice), next);
+    __m128i values = _mm_or_si128(_mm_and_si128(nextIsDigit, pair), _mm_andnot_si128(nextIsDigit, digits));
+
+    unsigned char lanes[16];
+    _mm_storeu_si128((__m128i *)lanes, values);
+    long done = *written;
+    while (starts != 0)
+    {
+        pixels[done++] = lanes[__builtin_ctz(starts)];
+        starts &= starts - 1;
+    }
+    *written = done;
+    // Leave the whitespace after the last number so the next block also starts between numbers.
+    *consumed = lastEnd + 1;
+    return SUCCESS;
+}
+#endif
+
+// This function parses the next count grey values into pixels.
+// It returns BAD_DATA when the file runs out early, or a value is not a number from 0 to 31.
+int parseEbfPixels(struct EbfParser *parser, unsigned char *pixels, long count)
+{
+    long written = 0;
+    while (written < count)
+    {
+        if (parser->position == parser->length && !refillEbfParser(parser))
+        {
+            // The final number may be ended by the end of the file rather than whitespace.
+            if (parser->inToken)
+            {
+                pixels[written++] = (unsigned char)parser->value;
+                parser->value = 0;
+                parser->inToken = 0;
+            }
+            if (written != count)
+                return BAD_DATA;
+            break;
+        }
+
+        const unsigned char *buffer = parser->buffer;
+#if defined(__SSE2__)
+        while (!parser->inToken && written < count && parser->length - parser->position >= 16)
+        {
+            int consumed = 0;
+            int check = scanEbfBlock16(buffer + parser->position, pixels, &written, count, &consumed);
+            if (check < 0)
+                break;
+            parser->position += consumed;
+        }
+#endif
+        // Scalar path for the tail of the block and for blocks the vector scanner refused.
+        // It runs on to the end of the current number so the vector scanner can take over again.
+        size_t end = parser->length;
+        if (end - parser->position > 16)
+            end = parser->position + 16;
+        while (written < count && parser->position < parser->length && (parser->position < end || parser->inToken))
+        {
+            if (scanEbfByte(parser, buffer[parser->position], pixels, &written) != SUCCESS)
+                return BAD_DATA;
+            parser->position++;
+        }
+    }
+
+    // Check the range of every value in one pass now that the text has been parsed.
+    return findBadPixel(pixels, count) == count ? SUCCESS : BAD_DATA;
+}
+
+// This function counts the grey values in a piece of ebf text, which is the number of runs of digits.
+// Nothing is checked, so the count is only right for text which then parses without error.
+long countEbfValues(const unsigned char *text, size_t length)
+{
+    long count = 0;
+    size_t position = 0;
+    // set when the byte before position is a digit, so a run crossing a block is counted once
+    unsigned int carry = 0;
+#if defined(__SSE2__)
+    for (; position + 16 <= length; position += 16)
+    {
+        __m128i digits = _mm_sub_epi8(_mm_loadu_si128((const __m128i *)(text + position)), _mm_set1_epi8('0'));
+        unsigned int digitMask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits));
+        count += __builtin_popcount(digitMask & ~((digitMask << 1) | carry));
+        carry = digitMask >> 15;
+    }
+#endif
+    for (; position < length; position++)
+    {
+        unsigned int digit = (unsigned int)(text[position] - '0') < 10;
+        count += digit & ~carry;
+        carry = digit;
+    }
+    return count;
+}
+
+// This function checks that nothing but whitespace follows the last grey value.
+int finishEbfParser(struct EbfParser *parser)
+{
+    if (parser->inToken)
+        return BAD_DATA;
+
+    do
+    {
+        for (; parser->position < parser->length; parser->position++)
+        {
+            if (!isEbfSpace(parser->buffer[parser->position]))
+                return BAD_DATA;
+        }
+    } while (refillEbfParser(parser));
+    return SUCCESS;
+}
+
+// This function reads the whole ebf payload of an image whose header has already been read.
+// It returns SUCCESS, BAD_MALLOC if the read block cannot be allocated, or BAD_DATA when
+// there are too few values, too many values or a value above 31.
+int readEbfPixels(FILE *inputFile, struct ImageFileInfo *imageFileInfo)
+{
+    struct EbfParser parser;
+    int check = initEbfParser(&parser, inputFile);
+    if (check != SUCCESS)
+        return check;
+
+    for (int row = 0; row < imageFileInfo->height && check == SUCCESS; row++)
+        check = parseEbfPixels(&parser, imageRow(imageFileInfo, row), imageFileInfo->width);
+    if (check == SUCCESS)
+        check = finishEbfParser(&parser);
+
+    freeEbfParser(&parser);
+    return check;
+}
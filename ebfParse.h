@@ -0,0 +1,52 @@
+#ifndef EBF_PARSE_H
+#define EBF_PARSE_H
+
+#include <stdio.h>
+#include "image.h"
+
+// Size of each block read from the file by the parser.
+#define EBF_BLOCK_SIZE (1 << 20)
+
+// Any grey value above this is clamped here while parsing so the running value never overflows.
+// Values are range checked once the whole row has been parsed.
+#define EBF_VALUE_LIMIT 32
+
+typedef struct EbfParser
+{
+    FILE *inputFile;
+
+    // Block of raw text read from the file and how far we have scanned through it.
+    unsigned char *buffer;
+    size_t length, position;
+
+    // Value of a number which has been started but not yet ended by whitespace.
+    unsigned int value;
+    int inToken;
+    int endOfFile;
+} EbfParser;
+
+// This function prepares a parser to read from inputFile with a block of EBF_BLOCK_SIZE bytes owned by the caller.
+void startEbfParser(struct EbfParser *parser, FILE *inputFile, unsigned char *buffer);
+
+// This function prepares a parser to read grey values from text already in memory.
+void startEbfTextParser(struct EbfParser *parser, const unsigned char *text, size_t length);
+
+// This function prepares a parser with a block of its own, to be freed with freeEbfParser.
+int initEbfParser(struct EbfParser *parser, FILE *inputFile);
+
+// This function frees the parser block.
+void freeEbfParser(struct EbfParser *parser);
+
+// This function parses the next count grey values into pixels.
+int parseEbfPixels(struct EbfParser *parser, unsigned char *pixels, long count);
+
+// This function checks that nothing but whitespace follows the last grey value.
+int finishEbfParser(struct EbfParser *parser);
+
+// This function counts the grey values in a piece of ebf text without parsing them.
+long countEbfValues(const unsigned char *text, size_t length);
+
+// This function reads the whole ebf payload of an image whose header has already been read.
+int readEbfPixels(FILE *inputFile, struct ImageFileInfo *imageFileInfo);
+
+#endif
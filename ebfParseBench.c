@@ -0,0 +1,105 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "image.h"
+#include "ebfParse.h"
+#include "ebfParallel.h"
+#include "taskPool.h"
+
+// Dimensions of the synthetic image which is parsed.
+#define BENCH_HEIGHT 4096
+#define BENCH_WIDTH 4096
+
+// This function returns the current time in seconds.
+double benchSeconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+    // Write a synthetic ebf payload into a temporary file.
+    FILE *payload = tmpfile();
+    if (payload == NULL)
+    {
+        printf("ERROR: Bad File Name (tmpfile)\n");
+        return BAD_FILE;
+    }
+    unsigned int seed = 1;
+    for (int row = 0; row < BENCH_HEIGHT; row++)
+    {
+        for (int col = 0; col < BENCH_WIDTH; col++)
+        {
+            seed = seed * 1103515245 + 12345;
+            fprintf(payload, "%u%c", (seed >> 16) % 32, (col == BENCH_WIDTH - 1) ? '\n' : ' ');
+        }
+    }
+    long payloadBytes = ftell(payload);
+
+    struct ImageFileInfo imageFileInfo;
+    initImageFileInfo(&imageFileInfo);
+    imageFileInfo.height = BENCH_HEIGHT;
+    imageFileInfo.width = BENCH_WIDTH;
+    if (allocateImageData(&imageFileInfo) != SUCCESS)
+    {
+        fclose(payload);
+        printf("ERROR: Image Malloc Failed\n");
+        return BAD_MALLOC;
+    }
+
+    // Time the block parser.
+    rewind(payload);
+    double start = benchSeconds();
+    int check = readEbfPixels(payload, &imageFileInfo);
+    double parserTime = benchSeconds() - start;
+
+    // Time the chunked parser on every pool thread, from a copy of the payload in memory.
+    long threadCount = poolThreadCount();
+    unsigned char *text = (unsigned char *)malloc(payloadBytes);
+    unsigned char *parallelPixels = (unsigned char *)malloc(imageFileInfo.numBytes);
+    double parallelTime = 0;
+    rewind(payload);
+    if (text == NULL || parallelPixels == NULL || fread(text, 1, payloadBytes, payload) != (size_t)payloadBytes)
+        check = BAD_MALLOC;
+    else
+    {
+        start = benchSeconds();
+        if (parseEbfText(text, payloadBytes, parallelPixels, imageFileInfo.numBytes, (int)threadCount) != SUCCESS ||
+            memcmp(parallelPixels, imageFileInfo.imageData, imageFileInfo.numBytes) != 0)
+            check = BAD_DATA;
+        parallelTime = benchSeconds() - start;
+    }
+    free(text);
+    free(parallelPixels);
+
+    // Time the per pixel fscanf loop it replaced.
+    rewind(payload);
+    unsigned int value;
+    start = benchSeconds();
+    for (long i = 0; i < imageFileInfo.numBytes; i++)
+    {
+        if (fscanf(payload, "%u", &value) != 1 || value != imageFileInfo.imageData[i])
+            check = BAD_DATA;
+    }
+    double fscanfTime = benchSeconds() - start;
+
+    clearImageData(&imageFileInfo);
+    fclose(payload);
+    if (check != SUCCESS)
+    {
+        reportImageError(check, "tmpfile");
+        return check;
+    }
+
+    // one line of JSON for each parser, in the same form as ebbench
+    printf("{\"operation\":\"parse\",\"format\":\"ebf\",\"pixels\":%ld,\"bytes\":%ld,\"seconds\":%.6f,\"mb_per_s\":%.2f,\"pixels_per_s\":%.0f}\n",
+           imageFileInfo.numBytes, payloadBytes, parserTime, payloadBytes / parserTime / 1e6, imageFileInfo.numBytes / parserTime);
+    printf("{\"operation\":\"parse_parallel\",\"format\":\"ebf\",\"threads\":%ld,\"pixels\":%ld,\"bytes\":%ld,\"seconds\":%.6f,\"mb_per_s\":%.2f,\"pixels_per_s\":%.0f}\n",
+           threadCount, imageFileInfo.numBytes, payloadBytes, parallelTime, payloadBytes / parallelTime / 1e6, imageFileInfo.numBytes / parallelTime);
+    printf("{\"operation\":\"parse_fscanf\",\"format\":\"ebf\",\"pixels\":%ld,\"bytes\":%ld,\"seconds\":%.6f,\"mb_per_s\":%.2f,\"pixels_per_s\":%.0f}\n",
+           imageFileInfo.numBytes, payloadBytes, fscanfTime, payloadBytes / fscanfTime / 1e6, imageFileInfo.numBytes / fscanfTime);
+    return SUCCESS;
+}
@@ -0,0 +1,53 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "image.h"
+#include "imageCodec.h"
+#include "benchImage.h"
+
+int main(int argc, char **argv)
+{
+    // main
+    if (argc == 1)
+    {
+        printf("Usage: ebgen format height width seed file");
+        return SUCCESS;
+    }
+    // validate that user has entered the format, the size, the seed and the output file
+    if (argc != 6) // check arg count
+    {
+        printf("ERROR: Bad Arguments\n");
+        return BAD_ARGS;
+    }
+
+    const struct ImageCodec *codec = findImageCodecByName(argv[1]);
+    if (codec == NULL)
+    {
+        printf("ERROR: Bad Arguments\n");
+        return BAD_ARGS;
+    }
+
+    char *end1, *end2, *end3;
+    long height = strtol(argv[2], &end1, 10), width = strtol(argv[3], &end2, 10);
+    unsigned long seed = strtoul(argv[4], &end3, 10);
+    if (*end1 != '\0' || *end2 != '\0' || *end3 != '\0')
+    {
+        printf("ERROR: Bad Arguments\n");
+        return BAD_ARGS;
+    }
+    if (height < MIN_DIMENSION || width < MIN_DIMENSION || height > MAX_DIMENSION || width > MAX_DIMENSION)
+    {
+        printf("ERROR: Bad Dimensions (%s)\n", argv[5]);
+        return BAD_DIM;
+    }
+
+    int check = generateImageFile(argv[5], codec->magicNumber, (int)height, (int)width, (uint32_t)seed);
+    if (check != SUCCESS)
+    {
+        reportImageError(check, argv[5]);
+        return check;
+    }
+
+    // print final success message and return
+    printf("GENERATED\n");
+    return SUCCESS;
+} // main()
@@ -0,0 +1,24 @@
+#include <stdio.h>
+#include <string.h>
+#include "image.h"
+#include "imageHash.h"
+
+int main(int argc, char **argv)
+{
+    // main
+    if (argc == 1)
+    {
+        printf("Usage: ebhash file");
+        return SUCCESS;
+    }
+    // validate that user has enter 1 argument (plus the executable name),
+    // optionally after --cache to keep the hash in a sidecar
+    int cache = argc == 3 && strcmp(argv[1], "--cache") == 0;
+    if (argc != 2 && !cache) // check arg count
+    {
+        printf("ERROR: Bad Arguments\n");
+        return BAD_ARGS;
+    }
+    return printImageHash(argv[argc - 1], cache);
+
+} // main()
@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "imageStream.h"
+#include "ebcPack.h"
+#include "ebcTile.h"
+
+// This function makes sure a block kept by a reader or writer holds at least size bytes.
+// Blocks only ever grow, so one sized for a wide image is reused as it is for a narrower one.
+static int growEbtBlock(unsigned char **block, size_t *capacity, size_t size)
+{
+    if (*capacity >= size)
+        return SUCCESS;
+    unsigned char *larger = (unsigned char *)realloc(*block, size);
+    if (larger == NULL)
+        return BAD_MALLOC;
+    *block = larger;
+    *capacity = size;
+    return SUCCESS;
+}
+
+// This function returns the number of packed bytes in one band of tiles.
+static size_t ebtBandBytes(int height, int width, int tileSize, long tileRow)
+{
+    long bandHeight = ebtTileExtent(height, tileSize, tileRow);
+    size_t size = 0;
+    for (long column = 0; column < ebtTileCount(width, tileSize); column++)
+        size += (size_t)ebcPackedSize(bandHeight * ebtTileExtent(width, tileSize, column));
+    return size;
+}
+
+// This function reads the tile size and the tile index, and sets up the blocks a band is unpacked in.
+// The index must describe exactly the tiles the header asks for, each packed to its full size.
+static int startEbtReader(struct ImageReader *reader)
+{
+    int check = readEbtTileSize(reader->inputFile, &reader->tileSize);
+    if (check != SUCCESS)
+        return check;
+
+    int height = reader->header.height, width = reader->header.width, tileSize = reader->tileSize;
+    if (reader->unpacked == NULL)
+        reader->unpacked = (unsigned char *)malloc(ebcBlockPixels());
+    if (reader->unpacked == NULL || growEbtBlock(&reader->band, &reader->bandCapacity, (size_t)tileSize * width) != SUCCESS ||
+        growEbtBlock(&reader->bandPacked, &reader->bandPackedCapacity, ebtBandBytes(height, width, tileSize, 0)) != SUCCESS)
+        return BAD_MALLOC;
+    reader->tileRow = 0;
+
+    uint64_t expected = 0;
+    long across = ebtTileCount(width, tileSize), tiles = across * ebtTileCount(height, tileSize);
+    unsigned char entry[EBT_INDEX_ENTRY_BYTES];
+    for (long tile = 0; tile <= tiles; tile++)
+    {
+        if (fread(entry, 1, EBT_INDEX_ENTRY_BYTES, reader->inputFile) != EBT_INDEX_ENTRY_BYTES || loadEbtOffset(entry) != expected)
+            return BAD_DATA;
+        if (tile < tiles)
+            expected += (uint64_t)ebcPackedSize((long)ebtTileExtent(height, tileSize, tile / across) * ebtTileExtent(width, tileSize, tile % across));
+    }
+    return SUCCESS;
+}
+
+// This function reads the next band of tiles and unpacks each tile into its place in the band.
+static int unpackEbtBand(struct ImageReader *reader)
+{
+    int height = reader->header.height, width = reader->header.width, tileSize = reader->tileSize;
+    if (reader->tileRow >= ebtTileCount(height, tileSize))
+        return BAD_DATA;
+
+    size_t size = ebtBandBytes(height, width, tileSize, reader->tileRow);
+    if (fread(reader->bandPacked, 1, size, reader->inputFile) != size)
+        return BAD_DATA;
+
+    int bandHeight = ebtTileExtent(height, tileSize, reader->tileRow);
+    const unsigned char *packed = reader->bandPacked;
+    for (long column = 0; column < ebtTileCount(width, tileSize); column++)
+    {
+        int tileWidth = ebtTileExtent(width, tileSize, column);
+        long count = (long)bandHeight * tileWidth;
+        unpackEbcPixels(packed, count, reader->unpacked);
+        for (int row = 0; row < bandHeight; row++)
+            memcpy(reader->band + (size_t)row * width + column * tileSize, reader->unpacked + (size_t)row * tileWidth, tileWidth);
+        packed += ebcPackedSize(count);
+    }
+
+    reader->unpackedPosition = 0;
+    reader->unpackedCount = (long)bandHeight * width;
+    reader->tileRow++;
+    return SUCCESS;
+}
+
+// This function hands out the next count pixels, unpacking a band of tiles whenever the last one runs out.
+static int readEbtPixels(struct ImageReader *reader, unsigned char *pixels, long count)
+{
+    long done = 0;
+    while (done < count)
+    {
+        long available = reader->unpackedCount - reader->unpackedPosition;
+        if (available == 0)
+        {
+            if (unpackEbtBand(reader) != SUCCESS)
+                return BAD_DATA;
+            continue;
+        }
+        long take = count - done < available ? count - done : available;
+        memcpy(pixels + done, reader->band + reader->unpackedPosition, take);
+        reader->unpackedPosition += take;
+        done += take;
+    }
+    return SUCCESS;
+}
+
+// This function checks that the file ends with the last tile.
+static int finishEbtReader(struct ImageReader *reader)
+{
+    return getc(reader->inputFile) == EOF ? SUCCESS : BAD_DATA;
+}
+
+// This function sets up the band pixels are gathered in and the block each tile is packed from.
+static int startEbtWriter(struct ImageWriter *writer)
+{
+    writer->tileRow = 0;
+    writer->bandCount = 0;
+    if (writer->pending == NULL)
+        writer->pending = (unsigned char *)malloc(ebcBlockPixels());
+    if (writer->pending == NULL || growEbtBlock(&writer->band, &writer->bandCapacity, (size_t)EBT_TILE_SIZE * writer->width) != SUCCESS)
+        return BAD_MALLOC;
+    return SUCCESS;
+}
+
+// This function writes the tile size and the tile index, which follow the dimensions.
+// Every tile is packed to a size fixed by its dimensions, so the whole index is known before any pixel.
+static int writeEbtIndex(struct ImageWriter *writer)
+{
+    int height = (int)(writer->numBytes / writer->width), width = writer->width;
+    if (reserveImageWriter(writer, 16) != SUCCESS)
+        return BAD_OUTPUT;
+    writer->buffered += (size_t)sprintf((char *)writer->buffer + writer->buffered, "%d\n", EBT_TILE_SIZE);
+
+    uint64_t offset = 0;
+    long across = ebtTileCount(width, EBT_TILE_SIZE), tiles = across * ebtTileCount(height, EBT_TILE_SIZE);
+    for (long tile = 0; tile <= tiles; tile++)
+    {
+        if (reserveImageWriter(writer, EBT_INDEX_ENTRY_BYTES) != SUCCESS)
+            return BAD_OUTPUT;
+        storeEbtOffset(writer->buffer + writer->buffered, offset);
+        writer->buffered += EBT_INDEX_ENTRY_BYTES;
+        if (tile < tiles)
+            offset += (uint64_t)ebcPackedSize((long)ebtTileExtent(height, EBT_TILE_SIZE, tile / across) * ebtTileExtent(width, EBT_TILE_SIZE, tile % across));
+    }
+    return SUCCESS;
+}
+
+// This function packs each tile of the band gathered so far into the buffer.
+// The index goes out just before the first band.
+static int packEbtBand(struct ImageWriter *writer)
+{
+    if (writer->tileRow == 0 && writeEbtIndex(writer) != SUCCESS)
+        return BAD_OUTPUT;
+
+    int width = writer->width, bandHeight = (int)(writer->bandCount / width);
+    for (long column = 0; column < ebtTileCount(width, EBT_TILE_SIZE); column++)
+    {
+        int tileWidth = ebtTileExtent(width, EBT_TILE_SIZE, column);
+        for (int row = 0; row < bandHeight; row++)
+            memcpy(writer->pending + (size_t)row * tileWidth, writer->band + (size_t)row * width + column * EBT_TILE_SIZE, tileWidth);
+
+        long count = (long)bandHeight * tileWidth;
+        size_t size = (size_t)ebcPackedSize(count);
+        if (reserveImageWriter(writer, size) != SUCCESS)
+            return BAD_OUTPUT;
+        packEbcPixels(writer->pending, count, writer->buffer + writer->buffered);
+        writer->buffered += size;
+    }
+    writer->tileRow++;
+    writer->bandCount = 0;
+    return SUCCESS;
+}
+
+// This function gathers count pixels, packing the tiles of each band as it fills.
+static int writeEbtPixels(struct ImageWriter *writer, const unsigned char *pixels, long count)
+{
+    long bandPixels = (long)EBT_TILE_SIZE * writer->width;
+    int check = SUCCESS;
+    for (long done = 0; done < count && check == SUCCESS;)
+    {
+        long take = bandPixels - writer->bandCount;
+        if (take > count - done)
+            take = count - done;
+        memcpy(writer->band + writer->bandCount, pixels + done, take);
+        writer->bandCount += take;
+        done += take;
+        if (writer->bandCount == bandPixels)
+            check = packEbtBand(writer);
+    }
+    writer->pixelsWritten += count;
+    return check;
+}
+
+// This function packs the last band, which is less than a tile high when the height is not a multiple of the tile size.
+static int finishEbtWriter(struct ImageWriter *writer)
+{
+    if (writer->bandCount > 0)
+        return packEbtBand(writer);
+    return SUCCESS;
+}
+
+const struct ImageCodec ebtCodec = {
+    "ebt", MAGIC_NUMBER_EBT,
+    startEbtReader, readEbtPixels, finishEbtReader,
+    startEbtWriter, writeEbtPixels, finishEbtWriter};
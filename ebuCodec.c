@@ -0,0 +1,62 @@
+#include <stdio.h>
+#include <string.h>
+#include "imageStream.h"
+#include "pixelCheck.h"
+
+// This function skips the one separator between the header and the raw pixel bytes.
+static int startEbuReader(struct ImageReader *reader)
+{
+    getc(reader->inputFile);
+    return SUCCESS;
+}
+
+// This function reads count raw pixel bytes and checks they are in range.
+static int readEbuPixels(struct ImageReader *reader, unsigned char *pixels, long count)
+{
+    if (fread(pixels, 1, count, reader->inputFile) != (size_t)count || findBadPixel(pixels, count) != count)
+        return BAD_DATA;
+    return SUCCESS;
+}
+
+// This function checks that the file ends with the last pixel.
+static int finishEbuReader(struct ImageReader *reader)
+{
+    return getc(reader->inputFile) == EOF ? SUCCESS : BAD_DATA;
+}
+
+// The ebu writer needs no block beyond the shared buffer.
+static int startEbuWriter(struct ImageWriter *writer)
+{
+    return SUCCESS;
+}
+
+// This function writes count raw pixel bytes.
+static int writeEbuPixels(struct ImageWriter *writer, const unsigned char *pixels, long count)
+{
+    int check;
+    // large runs of raw bytes go straight to the file or memory rather than through the buffer
+    if (count >= IMAGE_WRITE_BUFFER / 2)
+    {
+        check = flushImageWriter(writer);
+        if (check == SUCCESS)
+            check = writeImageBytes(writer, pixels, (size_t)count);
+    }
+    else if ((check = reserveImageWriter(writer, (size_t)count)) == SUCCESS)
+    {
+        memcpy(writer->buffer + writer->buffered, pixels, count);
+        writer->buffered += count;
+    }
+    writer->pixelsWritten += count;
+    return check;
+}
+
+// Every byte is in the buffer or the file as soon as it is written.
+static int finishEbuWriter(struct ImageWriter *writer)
+{
+    return SUCCESS;
+}
+
+const struct ImageCodec ebuCodec = {
+    "ebu", MAGIC_NUMBER_EBU,
+    startEbuReader, readEbuPixels, finishEbuReader,
+    startEbuWriter, writeEbuPixels, finishEbuWriter};
@@ -1,4 +1,6 @@
-#include "ucomp.h"
+#include <stdio.h>
+#include "image.h"
+#include "streamComp.h"
 
 int main(int argc, char **argv)
 {
@@ -9,11 +11,14 @@ int main(int argc, char **argv)
         return SUCCESS;
     } 
     // validate that user has enter 2 arguments (plus the executable name)
-    if (argc != 3) // check arg count 
+    // and optionally --hash or --cache before them to compare content hashes,
+    // or --stats to report how much the images differ
+    int mode = argc == 4 ? findCompareMode(argv[1]) : COMPARE_PIXELS;
+    if ((argc != 3 && argc != 4) || mode < 0) // check arg count 
     { 
         printf("ERROR: Bad Arguments\n");
         return BAD_ARGS;
     }
 
-    return run(argc, argv);    
+    return compareImagesBy(argv[argc - 2], argv[argc - 1], MAGIC_NUMBER_EBU, mode);    
 } // main()
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ebuMap.h"
+#include "pixelCheck.h"
+
+// This function reads the whole of a file that could not be mapped (a pipe for example).
+// It returns a malloced copy of the contents, or NULL when memory runs out.
+static unsigned char *slurpEbuFile(int fileDescriptor, size_t *length)
+{
+    size_t capacity = 1 << 16, used = 0;
+    unsigned char *contents = (unsigned char *)malloc(capacity);
+    while (contents != NULL)
+    {
+        if (used == capacity)
+        {
+            unsigned char *larger = (unsigned char *)realloc(contents, capacity * 2);
+            if (larger == NULL)
+            {
+                free(contents);
+                return NULL;
+            }
+            contents = larger;
+            capacity *= 2;
+        }
+        ssize_t got = read(fileDescriptor, contents + used, capacity - used);
+        if (got <= 0)
+            break;
+        used += got;
+    }
+    *length = used;
+    return contents;
+}
+
+// This function opens an ebu file and sets imageData to a view of its pixels inside a private mapping of
+// the file, so nothing is copied. The view is writable like any other image: a page written to is copied
+// on the first write and the file itself never changes. The view is released by clearImageData.
+// Files which cannot be mapped are read and their pixels copied into an ordinary block instead.
+// Nothing is printed, the error code is returned for the caller to report.
+int readEbuImage(struct ImageFileInfo *imageFileInfo, const char *fileName)
+{
+    // open the input file in read mode
+    int fileDescriptor = open(fileName, O_RDONLY);
+    struct stat fileStatus;
+    if (fileDescriptor < 0 || fstat(fileDescriptor, &fileStatus) != 0)
+    { // check file descriptor
+        if (fileDescriptor >= 0)
+            close(fileDescriptor);
+        return BAD_FILE;
+    } // check file descriptor
+
+    // map regular files copy on write, the mapping stays valid once the descriptor is closed
+    size_t length = 0;
+    unsigned char *contents = NULL;
+    int mapped = 0;
+    if (S_ISREG(fileStatus.st_mode) && fileStatus.st_size > 0)
+    {
+        length = (size_t)fileStatus.st_size;
+        void *mapping = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileDescriptor, 0);
+        if (mapping != MAP_FAILED)
+        {
+            contents = (unsigned char *)mapping;
+            mapped = 1;
+            posix_madvise(mapping, length, POSIX_MADV_SEQUENTIAL);
+        }
+    }
+    if (!mapped && (!S_ISREG(fileStatus.st_mode) || fileStatus.st_size > 0))
+    {
+        contents = slurpEbuFile(fileDescriptor, &length);
+        if (contents == NULL)
+        {
+            close(fileDescriptor);
+            return BAD_MALLOC;
+        }
+    }
+    close(fileDescriptor);
+
+    // first 2 characters should be the magic number, then the dimensions, which are checked like any other header
+    size_t position = 2;
+    int check = parseImageHeader(contents, length, &position, imageFileInfo, MAGIC_NUMBER_EBU);
+
+    // one newline separates the header from the raw pixel bytes, which must fill the rest of the file exactly
+    position++;
+    if (check == SUCCESS && (position > length || length - position != (size_t)imageFileInfo->numBytes ||
+                             findBadPixel(contents + position, imageFileInfo->numBytes) != imageFileInfo->numBytes))
+        check = BAD_DATA;
+
+    if (check == SUCCESS && mapped)
+    {
+        // hand out the view and keep the mapping until clearImageData
+        imageFileInfo->imageData = contents + position;
+        imageFileInfo->mapping = contents;
+        imageFileInfo->mappingLength = length;
+        return SUCCESS;
+    }
+    if (check == SUCCESS)
+    {
+        if ((check = allocateImageData(imageFileInfo)) == SUCCESS)
+            memcpy(imageFileInfo->imageData, contents + position, imageFileInfo->numBytes);
+    }
+
+    if (mapped)
+        munmap(contents, length);
+    else
+        free(contents);
+    return check;
+}
@@ -0,0 +1,9 @@
+#ifndef EBU_MAP_H
+#define EBU_MAP_H
+
+#include "image.h"
+
+// This function points imageData at the pixels of an ebu file mapped into memory.
+int readEbuImage(struct ImageFileInfo *imageFileInfo, const char *fileName);
+
+#endif
@@ -0,0 +1,525 @@
+#include <stdint.h>
+#include <string.h>
+#include "ebzCode.h"
+#include "ebcPack.h"
+
+// This function returns the number of zeros at the start of pixels, looking at no more than count.
+static long countZeroRun(const unsigned char *pixels, long count)
+{
+    long run = 0;
+    for (uint64_t word; run + 8 <= count; run += 8)
+    {
+        memcpy(&word, pixels + run, sizeof(word));
+        if (word != 0)
+            break;
+    }
+    while (run < count && pixels[run] == 0)
+        run++;
+    return run;
+}
+
+// This function returns k for a run of 2^k to 2^(k+1) - 1 zeros.
+static inline int ebzRunBits(long run)
+{
+    return 63 - __builtin_clzl((unsigned long)run);
+}
+
+// This function works out a Huffman code length for every symbol which is used, none longer than
+// EBZ_MAX_CODE_LENGTH. The two lightest nodes are merged until one is left, which with so few
+// symbols is quickest done by searching. Lengths over the limit are cut to it, and then the longest
+// codes still under it are lengthened until the code is complete again.
+static void buildEbzLengths(const long *frequency, unsigned char *length)
+{
+    long weight[2 * EBZ_SYMBOLS];
+    int parent[2 * EBZ_SYMBOLS], symbol[EBZ_SYMBOLS], leaves = 0;
+    memset(length, 0, EBZ_SYMBOLS);
+    for (int s = 0; s < EBZ_SYMBOLS; s++)
+    {
+        if (frequency[s] > 0)
+        {
+            weight[leaves] = frequency[s];
+            symbol[leaves++] = s;
+        }
+    }
+    if (leaves == 1)
+        length[symbol[0]] = 1;
+    if (leaves <= 1)
+        return;
+
+    int nodes = leaves;
+    for (int node = 0; node < 2 * leaves; node++)
+        parent[node] = -1;
+    for (int merges = 0; merges < leaves - 1; merges++)
+    {
+        int first = -1, second = -1;
+        for (int node = 0; node < nodes; node++)
+        {
+            if (parent[node] >= 0)
+                continue;
+            if (first < 0 || weight[node] < weight[first])
+            {
+                second = first;
+                first = node;
+            }
+            else if (second < 0 || weight[node] < weight[second])
+                second = node;
+        }
+        weight[nodes] = weight[first] + weight[second];
+        parent[first] = parent[second] = nodes++;
+    }
+
+    // Kraft sum in units of the shortest step, which must come to exactly one whole
+    long kraft = 0;
+    for (int leaf = 0; leaf < leaves; leaf++)
+    {
+        int depth = 0;
+        for (int node = leaf; parent[node] >= 0; node = parent[node])
+            depth++;
+        if (depth > EBZ_MAX_CODE_LENGTH)
+            depth = EBZ_MAX_CODE_LENGTH;
+        length[symbol[leaf]] = (unsigned char)depth;
+        kraft += 1L << (EBZ_MAX_CODE_LENGTH - depth);
+    }
+    while (kraft > 1L << EBZ_MAX_CODE_LENGTH)
+    {
+        int pick = -1;
+        for (int s = 0; s < EBZ_SYMBOLS; s++)
+            if (length[s] > 0 && length[s] < EBZ_MAX_CODE_LENGTH && (pick < 0 || length[s] > length[pick]))
+                pick = s;
+        kraft -= 1L << (EBZ_MAX_CODE_LENGTH - length[pick] - 1);
+        length[pick]++;
+    }
+}
+
+// This function gives each symbol its canonical code, bit reversed so that it can be written and
+// looked up least significant bit first. It returns 0 when the lengths claim more codes than exist.
+static int buildEbzCodes(const unsigned char *length, unsigned int *code)
+{
+    int count[EBZ_MAX_CODE_LENGTH + 1] = {0};
+    for (int s = 0; s < EBZ_SYMBOLS; s++)
+        count[length[s]]++;
+
+    unsigned int next[EBZ_MAX_CODE_LENGTH + 1];
+    unsigned int value = 0;
+    count[0] = 0;
+    for (int bits = 1; bits <= EBZ_MAX_CODE_LENGTH; bits++)
+    {
+        value = (value + count[bits - 1]) << 1;
+        next[bits] = value;
+        if (value + count[bits] > 1u << bits)
+            return 0;
+    }
+
+    for (int s = 0; s < EBZ_SYMBOLS; s++)
+    {
+        if (length[s] == 0)
+            continue;
+        unsigned int forward = next[length[s]]++, reversed = 0;
+        for (int bit = 0; bit < length[s]; bit++)
+            reversed |= ((forward >> bit) & 1) << (length[s] - 1 - bit);
+        code[s] = reversed;
+    }
+    return 1;
+}
+
+// A writer of bits, least significant first.
+typedef struct EbzBits
+{
+    unsigned char *out;
+    uint64_t bits;
+    int count;
+} EbzBits;
+
+// This function adds the low size bits of value, writing out whole words as they fill.
+static inline void putEbzBits(struct EbzBits *writer, uint64_t value, int size)
+{
+    writer->bits |= value << writer->count;
+    writer->count += size;
+    if (writer->count >= 32)
+    {
+        for (int byte = 0; byte < 4; byte++)
+            *writer->out++ = (unsigned char)(writer->bits >> (8 * byte));
+        writer->bits >>= 32;
+        writer->count -= 32;
+    }
+}
+
+// This function stores a strip's mode and the length of its data.
+static void storeEbzHeader(unsigned char *strip, int mode, long length)
+{
+    strip[0] = (unsigned char)mode;
+    for (int byte = 0; byte < 4; byte++)
+        strip[1 + byte] = (unsigned char)(length >> (8 * byte));
+}
+
+// This function returns the first pixel of a stream: the strip is split into EBZ_STREAMS equal parts,
+// the last one shorter.
+static inline long ebzStreamStart(long count, int stream)
+{
+    long part = (count + EBZ_STREAMS - 1) / EBZ_STREAMS, start = part * stream;
+    return start < count ? start : count;
+}
+
+// This function counts the symbols count pixels make and returns the bits of run lengths they need.
+static long countEbzSymbols(const unsigned char *pixels, long count, long *frequency)
+{
+    long bits = 0;
+    for (long at = 0; at < count;)
+    {
+        long run = pixels[at] == 0 ? countZeroRun(pixels + at, count - at) : 0;
+        if (run < 2)
+            frequency[pixels[at++] & 31]++;
+        else
+        {
+            frequency[EBZ_RUN_SYMBOL + ebzRunBits(run)]++;
+            bits += ebzRunBits(run);
+            at += run;
+        }
+    }
+    return bits;
+}
+
+// This function codes count pixels as one stream at out and returns the bytes written.
+static long writeEbzStream(const unsigned char *pixels, long count, const unsigned char *length, const unsigned int *code, unsigned char *out)
+{
+    struct EbzBits writer = {out, 0, 0};
+    for (long at = 0; at < count;)
+    {
+        long run = pixels[at] == 0 ? countZeroRun(pixels + at, count - at) : 0;
+        if (run < 2)
+        {
+            int value = pixels[at++] & 31;
+            putEbzBits(&writer, code[value], length[value]);
+        }
+        else
+        {
+            int k = ebzRunBits(run);
+            putEbzBits(&writer, code[EBZ_RUN_SYMBOL + k], length[EBZ_RUN_SYMBOL + k]);
+            putEbzBits(&writer, (uint64_t)(run - (1L << k)), k);
+            at += run;
+        }
+    }
+    for (; writer.count > 0; writer.count -= 8, writer.bits >>= 8)
+        *writer.out++ = (unsigned char)writer.bits;
+    return writer.out - out;
+}
+
+// This function stores count pixels, values from 0 to 31, as one strip and returns its size, which is
+// never more than ebzStripBound(count). Zero runs and grey values are counted first, which gives the
+// exact size of the coded strip, and the strip is only coded when that beats packing.
+long encodeEbzStrip(const unsigned char *pixels, long count, unsigned char *strip)
+{
+    long frequency[EBZ_STREAMS][EBZ_SYMBOLS] = {{0}}, total[EBZ_SYMBOLS] = {0}, bits[EBZ_STREAMS];
+    for (int stream = 0; stream < EBZ_STREAMS; stream++)
+    {
+        long start = ebzStreamStart(count, stream);
+        bits[stream] = countEbzSymbols(pixels + start, ebzStreamStart(count, stream + 1) - start, frequency[stream]);
+        for (int s = 0; s < EBZ_SYMBOLS; s++)
+            total[s] += frequency[stream][s];
+    }
+
+    unsigned char length[EBZ_SYMBOLS];
+    unsigned int code[EBZ_SYMBOLS];
+    buildEbzLengths(total, length);
+    buildEbzCodes(length, code);
+    long codedSize = EBZ_LENGTH_BYTES + EBZ_JUMP_BYTES;
+    for (int stream = 0; stream < EBZ_STREAMS; stream++)
+    {
+        for (int s = 0; s < EBZ_SYMBOLS; s++)
+            bits[stream] += frequency[stream][s] * length[s];
+        codedSize += (bits[stream] + 7) / 8;
+    }
+
+    long packedSize = ebcPackedSize(count);
+    if (codedSize >= packedSize)
+    {
+        storeEbzHeader(strip, EBZ_PACKED, packedSize);
+        packEbcPixels(pixels, count, strip + EBZ_STRIP_HEADER);
+        return EBZ_STRIP_HEADER + packedSize;
+    }
+
+    storeEbzHeader(strip, EBZ_CODED, codedSize);
+    unsigned char *data = strip + EBZ_STRIP_HEADER;
+    for (int s = 0; s < EBZ_SYMBOLS; s += 2)
+        data[s / 2] = (unsigned char)(length[s] | (s + 1 < EBZ_SYMBOLS ? length[s + 1] << 4 : 0));
+    unsigned char *jump = data + EBZ_LENGTH_BYTES, *out = jump + EBZ_JUMP_BYTES;
+    for (int stream = 0; stream < EBZ_STREAMS; stream++)
+    {
+        long start = ebzStreamStart(count, stream);
+        long size = writeEbzStream(pixels + start, ebzStreamStart(count, stream + 1) - start, length, code, out);
+        if (stream < EBZ_STREAMS - 1)
+            for (int byte = 0; byte < 4; byte++)
+                jump[4 * stream + byte] = (unsigned char)(size >> (8 * byte));
+        out += size;
+    }
+    return EBZ_STRIP_HEADER + codedSize;
+}
+
+// This function loads 8 bytes as a little endian word.
+static inline uint64_t loadEbzWord(const unsigned char *bytes)
+{
+    uint64_t word;
+    memcpy(&word, bytes, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+}
+
+// This function fills the decoding tables, which every possible EBZ_MAX_CODE_LENGTH bits are looked up in.
+// A single entry gives the symbol the bits start with and its length, and is zero for bits no code
+// starts with. A fast entry holds as many grey values, up to three, as the bits hold whole codes for,
+// one to a byte, with the bits they use and their number in the top byte. Its number is zero when
+// the bits start with a run, which is left to the single entries.
+static void buildEbzTables(const unsigned char *codeLength, const unsigned int *code, uint16_t *single, uint32_t *fast)
+{
+    memset(single, 0, EBZ_TABLE_SIZE * sizeof(*single));
+    for (int s = 0; s < EBZ_SYMBOLS; s++)
+        for (unsigned int fill = code[s]; codeLength[s] > 0 && fill < EBZ_TABLE_SIZE; fill += 1u << codeLength[s])
+            single[fill] = (uint16_t)(s << 4 | codeLength[s]);
+
+    for (unsigned int index = 0; index < EBZ_TABLE_SIZE; index++)
+    {
+        uint32_t entry = 0;
+        int used = 0, literals = 0;
+        while (literals < 3)
+        {
+            int size = single[index >> used] & 15, s = single[index >> used] >> 4;
+            if (size == 0 || used + size > EBZ_MAX_CODE_LENGTH || s >= EBZ_RUN_SYMBOL)
+                break;
+            entry |= (uint32_t)s << (8 * literals++);
+            used += size;
+        }
+        fast[index] = entry | (uint32_t)(literals << 4 | used) << 24;
+    }
+}
+
+// One stream of a coded strip being decoded: where its bits are read from, the bits not yet used,
+// and the pixels still to be filled.
+typedef struct EbzStream
+{
+    const unsigned char *in, *start, *limit;
+    uint64_t bits;
+    int available;
+    unsigned char *out, *end;
+} EbzStream;
+
+// This function tops up the bits of a stream to at least 56, checking it has not read past its data.
+// The buffer runs up to 8 bytes ahead of the bits used, which is all the slack after the data allows.
+static inline int refillEbzStream(struct EbzStream *stream)
+{
+    if (stream->in > stream->limit)
+        return BAD_DATA;
+    stream->bits |= loadEbzWord(stream->in) << stream->available;
+    stream->in += (63 - stream->available) >> 3;
+    stream->available |= 56;
+    return SUCCESS;
+}
+
+// This function decodes one symbol of a stream whose bits have been topped up, a grey value or a run
+// of zeros, and sets check when the bits are not a code or the run is too long. The stream is passed
+// and handed back whole so that the caller's copy never needs an address and stays in registers.
+static struct EbzStream decodeEbzSymbol(struct EbzStream stream, const uint16_t *single, int *check)
+{
+    int size = single[stream.bits & (EBZ_TABLE_SIZE - 1)] & 15, s = single[stream.bits & (EBZ_TABLE_SIZE - 1)] >> 4;
+    if (size == 0)
+    {
+        *check = BAD_DATA;
+        return stream;
+    }
+    stream.bits >>= size;
+    stream.available -= size;
+    if (s < EBZ_RUN_SYMBOL)
+    {
+        *stream.out++ = (unsigned char)s;
+        return stream;
+    }
+
+    int k = s - EBZ_RUN_SYMBOL;
+    long run = (1L << k) + (long)(stream.bits & ((1UL << k) - 1));
+    stream.bits >>= k;
+    stream.available -= k;
+    if (run > stream.end - stream.out)
+    {
+        *check = BAD_DATA;
+        return stream;
+    }
+    memset(stream.out, 0, run);
+    stream.out += run;
+    return stream;
+}
+
+// This function takes up to three grey values from one lookup and returns 1, or returns 0 and takes
+// nothing when the bits start with a run or the stream is nearly full.
+static inline int takeEbzValues(struct EbzStream *stream, const uint32_t *fast)
+{
+    uint32_t entry = fast[stream->bits & (EBZ_TABLE_SIZE - 1)];
+    if ((entry >> 28) == 0 || stream->end - stream->out < 3)
+        return 0;
+    stream->out[0] = (unsigned char)entry;
+    stream->out[1] = (unsigned char)(entry >> 8);
+    stream->out[2] = (unsigned char)(entry >> 16);
+    stream->out += entry >> 28;
+    stream->bits >>= (entry >> 24) & 15;
+    stream->available -= (entry >> 24) & 15;
+    return 1;
+}
+
+// This function takes one step of a stream: its bits are topped up, which is always enough for the
+// longest code and the longest run, then either a lookup of grey values or one symbol is decoded.
+static inline struct EbzStream stepEbzStream(struct EbzStream stream, const uint32_t *fast, const uint16_t *single, int *check)
+{
+    *check |= refillEbzStream(&stream);
+    if (!takeEbzValues(&stream, fast))
+        stream = decodeEbzSymbol(stream, single, check);
+    return stream;
+}
+
+// Lookups after each top up in the quick loop. Grey values use at most 12 bits a lookup, and a run
+// 30, so the 56 bits always cover the lookups before a run and the run.
+#define EBZ_QUICK_LOOKUPS 3
+
+// What a quick round of a stream came to: every lookup taken, stopped after a run, or bad data.
+#define EBZ_ROUND_DONE 0
+#define EBZ_ROUND_RUN 1
+#define EBZ_ROUND_BAD 2
+
+// This function returns how many rounds of quick lookups a stream can take without any check: each
+// top up moves on at most 7 bytes, and each round hands out at most EBZ_QUICK_LOOKUPS * 3 grey values.
+// A run hands out more, but it ends the round and the rounds are then worked out again.
+static inline long ebzQuickRounds(const struct EbzStream *stream)
+{
+    long byRead = (stream->limit - stream->in) / 8, byWritten = (stream->end - stream->out) / (EBZ_QUICK_LOOKUPS * 3);
+    return byRead < byWritten ? byRead : byWritten;
+}
+
+// This function tops up the bits of a stream and takes EBZ_QUICK_LOOKUPS lookups of grey values with no
+// checks, which the caller has made for a whole number of rounds. The round stops after a run.
+static inline int takeEbzQuickRound(struct EbzStream *stream, const uint32_t *fast, const uint16_t *single)
+{
+    stream->bits |= loadEbzWord(stream->in) << stream->available;
+    stream->in += (63 - stream->available) >> 3;
+    stream->available |= 56;
+    for (int lookup = 0; lookup < EBZ_QUICK_LOOKUPS; lookup++)
+    {
+        uint32_t entry = fast[stream->bits & (EBZ_TABLE_SIZE - 1)];
+        if ((entry >> 28) == 0)
+        {
+            int check = SUCCESS;
+            *stream = decodeEbzSymbol(*stream, single, &check);
+            return check == SUCCESS ? EBZ_ROUND_RUN : EBZ_ROUND_BAD;
+        }
+        stream->out[0] = (unsigned char)entry;
+        stream->out[1] = (unsigned char)(entry >> 8);
+        stream->out[2] = (unsigned char)(entry >> 16);
+        stream->out += entry >> 28;
+        stream->bits >>= (entry >> 24) & 15;
+        stream->available -= (entry >> 24) & 15;
+    }
+    return EBZ_ROUND_DONE;
+}
+
+// This function decodes a coded strip. Its streams are independent, so stepping them in turn keeps
+// several lookups in flight at once rather than waiting on one chain of bits.
+static int decodeEbzCoded(const unsigned char *data, size_t length, unsigned char *pixels, long count)
+{
+    if (length < EBZ_LENGTH_BYTES + EBZ_JUMP_BYTES)
+        return BAD_DATA;
+    unsigned char codeLength[EBZ_SYMBOLS];
+    unsigned int code[EBZ_SYMBOLS];
+    for (int s = 0; s < EBZ_SYMBOLS; s++)
+    {
+        codeLength[s] = (data[s / 2] >> (4 * (s & 1))) & 15;
+        if (codeLength[s] > EBZ_MAX_CODE_LENGTH)
+            return BAD_DATA;
+    }
+    if (!buildEbzCodes(codeLength, code))
+        return BAD_DATA;
+    uint16_t single[EBZ_TABLE_SIZE];
+    uint32_t fast[EBZ_TABLE_SIZE];
+    buildEbzTables(codeLength, code, single, fast);
+
+    struct EbzStream streams[EBZ_STREAMS];
+    const unsigned char *jump = data + EBZ_LENGTH_BYTES, *in = jump + EBZ_JUMP_BYTES, *end = data + length;
+    for (int stream = 0; stream < EBZ_STREAMS; stream++)
+    {
+        size_t size = (size_t)(end - in);
+        if (stream < EBZ_STREAMS - 1)
+        {
+            size = jump[4 * stream] | (size_t)jump[4 * stream + 1] << 8 | (size_t)jump[4 * stream + 2] << 16 | (size_t)jump[4 * stream + 3] << 24;
+            if (size > (size_t)(end - in))
+                return BAD_DATA;
+        }
+        streams[stream] = (struct EbzStream){in, in, in + size + 8, 0, 0, pixels + ebzStreamStart(count, stream), pixels + ebzStreamStart(count, stream + 1)};
+        in += size;
+    }
+
+    // The four streams take quick rounds together, held in locals of their own so that their bits stay
+    // in registers. Once one stream is close to its end the others finish on their own, each taking
+    // quick rounds while it can and careful steps after that.
+    struct EbzStream first = streams[0], second = streams[1], third = streams[2], fourth = streams[3];
+    for (;;)
+    {
+        long rounds = ebzQuickRounds(&first);
+        rounds = ebzQuickRounds(&second) < rounds ? ebzQuickRounds(&second) : rounds;
+        rounds = ebzQuickRounds(&third) < rounds ? ebzQuickRounds(&third) : rounds;
+        rounds = ebzQuickRounds(&fourth) < rounds ? ebzQuickRounds(&fourth) : rounds;
+        if (rounds == 0)
+            break;
+        int result = EBZ_ROUND_DONE;
+        for (long round = 0; round < rounds && result == EBZ_ROUND_DONE; round++)
+            result = takeEbzQuickRound(&first, fast, single) | takeEbzQuickRound(&second, fast, single) |
+                     takeEbzQuickRound(&third, fast, single) | takeEbzQuickRound(&fourth, fast, single);
+        if (result & EBZ_ROUND_BAD)
+            return BAD_DATA;
+    }
+    streams[0] = first;
+    streams[1] = second;
+    streams[2] = third;
+    streams[3] = fourth;
+
+    int check = SUCCESS;
+    for (int index = 0; index < EBZ_STREAMS; index++)
+    {
+        struct EbzStream stream = streams[index];
+        while (stream.out < stream.end)
+        {
+            int result = EBZ_ROUND_DONE;
+            for (long round = ebzQuickRounds(&stream); round > 0 && result == EBZ_ROUND_DONE; round--)
+                result = takeEbzQuickRound(&stream, fast, single);
+            if (result & EBZ_ROUND_BAD)
+                return BAD_DATA;
+            if (result == EBZ_ROUND_DONE && stream.out < stream.end)
+                stream = stepEbzStream(stream, fast, single, &check);
+            if (check != SUCCESS)
+                return BAD_DATA;
+        }
+        streams[index] = stream;
+    }
+
+    // each stream ends with the byte holding its last bit
+    for (int index = 0; index < EBZ_STREAMS; index++)
+    {
+        long used = (long)(streams[index].in - streams[index].start) * 8 - streams[index].available;
+        if (streams[index].start + (used + 7) / 8 != streams[index].limit - 8)
+            return BAD_DATA;
+    }
+    return SUCCESS;
+}
+
+// This function decodes the data of one strip into count pixels. The data must be followed by
+// EBZ_SLACK zero bytes. It returns BAD_DATA when the mode is unknown, the data is the wrong length
+// or does not decode to exactly count pixels.
+int decodeEbzStrip(int mode, const unsigned char *data, size_t length, unsigned char *pixels, long count)
+{
+    if (mode == EBZ_PACKED)
+    {
+        if (length != (size_t)ebcPackedSize(count))
+            return BAD_DATA;
+        unpackEbcPixels(data, count, pixels);
+        return SUCCESS;
+    }
+    if (mode == EBZ_CODED)
+        return decodeEbzCoded(data, length, pixels, count);
+    return BAD_DATA;
+}
@@ -0,0 +1,57 @@
+#ifndef EBZ_CODE_H
+#define EBZ_CODE_H
+
+#include <stddef.h>
+#include "image.h"
+
+// An ebz file ("ez") is ebc version 2: the same grey values, compressed a strip at a time.
+// After "ez\nH W" and one whitespace character, every strip of EBZ_STRIP_PIXELS pixels, and the
+// shorter last one, starts with a mode byte and the little endian 32 bit length of what follows.
+// A packed strip holds the 5 bit ebc packing of its pixels. A coded strip holds the Huffman code
+// length of each symbol as 4 bits, low half first, then the sizes of its streams but the last as
+// little endian 32 bit numbers, then the streams. Each stream codes a quarter of the pixels, the
+// last one shorter, least significant bit first and padded to a whole byte. Symbols below 32 are
+// grey values and symbol 32 + k is a run of 2^k to 2^(k+1) - 1 zeros, the rest of the run length
+// following in k bits. A run never crosses from one stream to the next.
+
+// Pixels in every strip but the last.
+#define EBZ_STRIP_PIXELS (1L << 18)
+
+// Modes a strip can be stored in.
+#define EBZ_PACKED 0
+#define EBZ_CODED 1
+
+// Bytes before the data of each strip.
+#define EBZ_STRIP_HEADER 5
+
+// Number of symbols: the 32 grey values, then the zero runs up to a whole strip.
+#define EBZ_RUN_SYMBOL 32
+#define EBZ_SYMBOLS (EBZ_RUN_SYMBOL + 19)
+
+// Longest code, which is also the number of bits the decoder looks up at once.
+#define EBZ_MAX_CODE_LENGTH 12
+#define EBZ_TABLE_SIZE (1 << EBZ_MAX_CODE_LENGTH)
+
+// Bytes of the code lengths at the start of a coded strip.
+#define EBZ_LENGTH_BYTES ((EBZ_SYMBOLS + 1) / 2)
+
+// Streams a coded strip is split into, which are decoded side by side, and the bytes of their sizes.
+#define EBZ_STREAMS 4
+#define EBZ_JUMP_BYTES (4 * (EBZ_STREAMS - 1))
+
+// Zero bytes the decoder needs after the data of a strip, as it reads whole words ahead.
+#define EBZ_SLACK 16
+
+// This function returns the most bytes a strip of count pixels can be stored in, header included.
+static inline long ebzStripBound(long count)
+{
+    return EBZ_STRIP_HEADER + (count * 5 + 7) / 8;
+}
+
+// This function stores count pixels as one strip in whichever mode is smaller and returns its size.
+long encodeEbzStrip(const unsigned char *pixels, long count, unsigned char *strip);
+
+// This function decodes the data of one strip, given its mode and length, into count pixels.
+int decodeEbzStrip(int mode, const unsigned char *data, size_t length, unsigned char *pixels, long count);
+
+#endif
@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "imageStream.h"
+#include "ebcPack.h"
+#include "ebzCode.h"
+
+// This function checks the one whitespace separator before the first strip and sets up the blocks
+// a strip is read and decoded in. They are the ebc blocks, which are larger than any strip.
+static int startEbzReader(struct ImageReader *reader)
+{
+    int separator = getc(reader->inputFile);
+    if (reader->packed == NULL)
+        reader->packed = (unsigned char *)malloc(ebcPackedSize(ebcBlockPixels()));
+    if (reader->unpacked == NULL)
+        reader->unpacked = (unsigned char *)malloc(ebcBlockPixels());
+    if (reader->packed == NULL || reader->unpacked == NULL)
+        return BAD_MALLOC;
+    if (separator != ' ' && separator != '\n' && separator != '\r' && separator != '\t')
+        return BAD_DATA;
+    return SUCCESS;
+}
+
+// This function reads the next strip, which holds count pixels, and decodes it into pixels.
+static int decodeEbzBlock(struct ImageReader *reader, unsigned char *pixels, long count)
+{
+    unsigned char header[EBZ_STRIP_HEADER];
+    if (count <= 0 || fread(header, 1, EBZ_STRIP_HEADER, reader->inputFile) != EBZ_STRIP_HEADER)
+        return BAD_DATA;
+    size_t length = header[1] | (size_t)header[2] << 8 | (size_t)header[3] << 16 | (size_t)header[4] << 24;
+    if (length > (size_t)(ebzStripBound(count) - EBZ_STRIP_HEADER) || fread(reader->packed, 1, length, reader->inputFile) != length)
+        return BAD_DATA;
+    memset(reader->packed + length, 0, EBZ_SLACK);
+    if (decodeEbzStrip(header[0], reader->packed, length, pixels, count) != SUCCESS)
+        return BAD_DATA;
+    reader->packedPixelsLeft -= count;
+    return SUCCESS;
+}
+
+// This function hands out the next count pixels.
+// Whole strips are decoded straight into pixels, and only a strip split between two calls
+// goes through the reader's own block, like ebc blocks.
+static int readEbzPixels(struct ImageReader *reader, unsigned char *pixels, long count)
+{
+    long done = 0;
+    while (done < count)
+    {
+        long available = reader->unpackedCount - reader->unpackedPosition;
+        if (available > 0)
+        {
+            long take = count - done < available ? count - done : available;
+            memcpy(pixels + done, reader->unpacked + reader->unpackedPosition, take);
+            reader->unpackedPosition += take;
+            done += take;
+            continue;
+        }
+
+        long strip = reader->packedPixelsLeft < EBZ_STRIP_PIXELS ? reader->packedPixelsLeft : EBZ_STRIP_PIXELS;
+        if (count - done >= strip)
+        {
+            if (decodeEbzBlock(reader, pixels + done, strip) != SUCCESS)
+                return BAD_DATA;
+            done += strip;
+        }
+        else
+        {
+            if (decodeEbzBlock(reader, reader->unpacked, strip) != SUCCESS)
+                return BAD_DATA;
+            reader->unpackedPosition = 0;
+            reader->unpackedCount = strip;
+        }
+    }
+    return SUCCESS;
+}
+
+// This function checks that the file ends with the last strip.
+static int finishEbzReader(struct ImageReader *reader)
+{
+    return getc(reader->inputFile) == EOF ? SUCCESS : BAD_DATA;
+}
+
+// This function sets up the block ebz pixels are gathered in.
+static int startEbzWriter(struct ImageWriter *writer)
+{
+    if (writer->pending == NULL)
+        writer->pending = (unsigned char *)malloc(ebcBlockPixels());
+    return writer->pending == NULL ? BAD_MALLOC : SUCCESS;
+}
+
+// This function encodes the pixels gathered so far as one strip, straight into the buffer.
+static int encodeEbzWriter(struct ImageWriter *writer)
+{
+    if (reserveImageWriter(writer, (size_t)ebzStripBound(writer->pendingCount)) != SUCCESS)
+        return BAD_OUTPUT;
+    writer->buffered += (size_t)encodeEbzStrip(writer->pending, writer->pendingCount, writer->buffer + writer->buffered);
+    writer->pendingCount = 0;
+    return SUCCESS;
+}
+
+// This function gathers count pixels, encoding each strip as it fills.
+static int writeEbzPixels(struct ImageWriter *writer, const unsigned char *pixels, long count)
+{
+    int check = SUCCESS;
+    for (long done = 0; done < count && check == SUCCESS;)
+    {
+        long take = EBZ_STRIP_PIXELS - writer->pendingCount;
+        if (take > count - done)
+            take = count - done;
+        memcpy(writer->pending + writer->pendingCount, pixels + done, take);
+        writer->pendingCount += take;
+        done += take;
+        if (writer->pendingCount == EBZ_STRIP_PIXELS)
+            check = encodeEbzWriter(writer);
+    }
+    writer->pixelsWritten += count;
+    return check;
+}
+
+// This function encodes the last, shorter strip.
+static int finishEbzWriter(struct ImageWriter *writer)
+{
+    if (writer->pendingCount > 0)
+        return encodeEbzWriter(writer);
+    return SUCCESS;
+}
+
+const struct ImageCodec ebzCodec = {
+    "ebz", MAGIC_NUMBER_EBZ,
+    startEbzReader, readEbzPixels, finishEbzReader,
+    startEbzWriter, writeEbzPixels, finishEbzWriter};
@@ -0,0 +1,249 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include "image.h"
+#include "imageArena.h"
+
+// Any dimension above this is already out of range, so parsing stops growing the value here.
+#define IMAGE_DIMENSION_LIMIT (MAX_DIMENSION + 1L)
+
+// A dimension of more significant digits than this is out of range whatever the digits are.
+#define IMAGE_DIMENSION_DIGITS 10
+
+// This function sets up an empty image so that it can be safely read into or cleared.
+void initImageFileInfo(struct ImageFileInfo *imageFileInfo)
+{
+    // Create a char array to hold magic number and cast to short.
+    imageFileInfo->magicNumberValue = (unsigned short *)imageFileInfo->magicNumber;
+    imageFileInfo->width = imageFileInfo->height = 0;
+    imageFileInfo->stride = 0;
+    imageFileInfo->imageData = NULL;
+    imageFileInfo->numBytes = 0;
+    imageFileInfo->mapping = NULL;
+    imageFileInfo->mappingLength = 0;
+    imageFileInfo->blockCapacity = 0;
+}
+
+// This function works out the number of bytes in an image of the given dimensions in 64 bits.
+// It returns BAD_MALLOC when the dimensions are negative or the size does not fit a long or a size_t,
+// which only happens where those are 32 bits, so nothing is ever allocated short.
+int countImageBytes(int height, int width, long *numBytes)
+{
+    if (height < 0 || width < 0)
+        return BAD_MALLOC;
+    uint64_t bytes = (uint64_t)height * (uint64_t)width;
+    if (bytes > (uint64_t)LONG_MAX || bytes > (uint64_t)(SIZE_MAX - IMAGE_ALIGNMENT))
+        return BAD_MALLOC;
+    *numBytes = (long)bytes;
+    return SUCCESS;
+}
+
+// This function allocates the pixel block for the dimensions already stored in the image.
+// One block is checked out of the image arena per image, whatever its height, so a process which
+// handles one image after another reuses the blocks of the earlier ones.
+int allocateImageData(struct ImageFileInfo *imageFileInfo)
+{
+    imageFileInfo->stride = imageFileInfo->width;
+    imageFileInfo->imageData = NULL;
+    imageFileInfo->blockCapacity = 0;
+    if (countImageBytes(imageFileInfo->height, imageFileInfo->width, &imageFileInfo->numBytes) != SUCCESS)
+        return BAD_MALLOC;
+
+    imageFileInfo->imageData = (unsigned char *)checkOutImageBlock((size_t)imageFileInfo->numBytes, &imageFileInfo->blockCapacity);
+    return imageFileInfo->imageData == NULL ? BAD_MALLOC : SUCCESS;
+}
+
+// This function is used to give the imageData block back to the image arena, or unmap the file it is a view into.
+void clearImageData(struct ImageFileInfo *imageFileInfo)
+{
+    if (imageFileInfo->mapping != NULL)
+    {
+        munmap(imageFileInfo->mapping, imageFileInfo->mappingLength);
+        imageFileInfo->mapping = NULL;
+        imageFileInfo->mappingLength = 0;
+    }
+    else
+        returnImageBlock(imageFileInfo->imageData, imageFileInfo->blockCapacity);
+    imageFileInfo->imageData = NULL;
+    imageFileInfo->blockCapacity = 0;
+}
+
+// This function copies an image which is a view into a mapped file into a block of its own and unmaps the file,
+// so the image outlives anything which truncates or rewrites that file, such as writing the image back to it.
+int detachImageData(struct ImageFileInfo *imageFileInfo)
+{
+    unsigned char *view = imageFileInfo->imageData;
+    if (imageFileInfo->mapping == NULL)
+        return SUCCESS;
+
+    imageFileInfo->imageData = (unsigned char *)checkOutImageBlock((size_t)imageFileInfo->numBytes, &imageFileInfo->blockCapacity);
+    if (imageFileInfo->imageData == NULL)
+    {
+        // keep the view, which clearImageData still unmaps
+        imageFileInfo->imageData = view;
+        imageFileInfo->blockCapacity = 0;
+        return BAD_MALLOC;
+    }
+    memcpy(imageFileInfo->imageData, view, (size_t)imageFileInfo->numBytes);
+    munmap(imageFileInfo->mapping, imageFileInfo->mappingLength);
+    imageFileInfo->mapping = NULL;
+    imageFileInfo->mappingLength = 0;
+    return SUCCESS;
+}
+
+// This function checks the magic number and dimensions which have been read into imageFileInfo.
+// It returns BAD_MAGIC_NUMBER or BAD_DIM, or sets the stride and size of the image and returns SUCCESS.
+// Every way of reading a header ends here, so the formats all accept exactly the same headers.
+int checkImageHeader(struct ImageFileInfo *imageFileInfo, unsigned short magicNumber)
+{
+    // checking against the casted value due to endienness.
+    if (*imageFileInfo->magicNumberValue != magicNumber)
+        return BAD_MAGIC_NUMBER;
+    if (imageFileInfo->height < MIN_DIMENSION || imageFileInfo->width < MIN_DIMENSION || imageFileInfo->height > MAX_DIMENSION || imageFileInfo->width > MAX_DIMENSION)
+        return BAD_DIM;
+
+    imageFileInfo->stride = imageFileInfo->width;
+    return countImageBytes(imageFileInfo->height, imageFileInfo->width, &imageFileInfo->numBytes);
+}
+
+// This function tells whether c is one of the whitespace characters that fscanf skips.
+static inline int isHeaderSpace(int c)
+{
+    return c == ' ' || (unsigned)(c - '\t') <= '\r' - '\t';
+}
+
+// This function reads one decimal dimension the way fscanf("%d") would, skipping leading whitespace,
+// but clamps it just past the largest legal dimension instead of overflowing.
+// It returns 0 when there is no number at position.
+static int scanImageDimension(const unsigned char *bytes, size_t length, size_t *position, int *dimension)
+{
+    size_t at = *position;
+    while (at < length && isHeaderSpace(bytes[at]))
+        at++;
+
+    int negative = 0;
+    if (at < length && (bytes[at] == '-' || bytes[at] == '+'))
+        negative = bytes[at++] == '-';
+
+    size_t first = at;
+    long value = 0;
+    for (; at < length && (unsigned char)(bytes[at] - '0') < 10; at++)
+    {
+        value = value * 10 + (bytes[at] - '0');
+        if (value > IMAGE_DIMENSION_LIMIT)
+            value = IMAGE_DIMENSION_LIMIT;
+    }
+    if (at == first)
+        return 0;
+
+    *dimension = (int)(negative ? -value : value);
+    *position = at;
+    return 1;
+}
+
+// This function parses the magic number and dimensions at the start of a buffered header and checks them.
+// position is left just after the width. Every way of reading a header parses it here.
+int parseImageHeader(const unsigned char *bytes, size_t length, size_t *position, struct ImageFileInfo *imageFileInfo, unsigned short magicNumber)
+{
+    imageFileInfo->magicNumber[0] = length > 0 ? bytes[0] : 0;
+    imageFileInfo->magicNumber[1] = length > 1 ? bytes[1] : 0;
+    if (*imageFileInfo->magicNumberValue != magicNumber)
+        return BAD_MAGIC_NUMBER;
+
+    *position = 2;
+    if (!scanImageDimension(bytes, length, position, &imageFileInfo->height) || !scanImageDimension(bytes, length, position, &imageFileInfo->width))
+        return BAD_DIM;
+    return checkImageHeader(imageFileInfo, magicNumber);
+}
+
+// This function copies one dimension from inputFile onto the end of prefix, which used bytes already fill,
+// starting from c, the character after what has been read. A run of whitespace is copied as one space, and
+// only the significant digits are copied. c is left at the first character after the dimension.
+// It returns 0 when there is no number to copy.
+static int gatherImageDimension(FILE *inputFile, unsigned char *prefix, size_t *used, int *c)
+{
+    if (isHeaderSpace(*c))
+        prefix[(*used)++] = ' ';
+    while (isHeaderSpace(*c))
+        *c = getc(inputFile);
+    if (*c == '-' || *c == '+')
+    {
+        prefix[(*used)++] = (unsigned char)*c;
+        *c = getc(inputFile);
+    }
+
+    int digits = 0, zero = 0;
+    for (; *c >= '0' && *c <= '9'; *c = getc(inputFile))
+    {
+        if (*c == '0' && digits == 0)
+            zero = 1;
+        else if (digits < IMAGE_DIMENSION_DIGITS)
+            prefix[(*used)++] = (unsigned char)*c, digits++;
+    }
+    if (digits == 0 && zero)
+        prefix[(*used)++] = '0';
+    return digits > 0 || zero;
+}
+
+// This function copies the header at the start of inputFile into prefix, which holds IMAGE_HEADER_PREFIX
+// bytes, and returns its length. Each dimension is copied by gatherImageDimension, so a header which fscanf
+// would accept always fits and parses the same. The file is left just after the width.
+static size_t gatherImageHeader(FILE *inputFile, unsigned char *prefix)
+{
+    size_t used = 0;
+    int c = EOF;
+    for (int at = 0; at < 2 && (c = getc(inputFile)) != EOF; at++)
+        prefix[used++] = (unsigned char)c;
+
+    c = getc(inputFile);
+    for (int dimension = 0; dimension < 2 && gatherImageDimension(inputFile, prefix, &used, &c); dimension++)
+        ;
+    if (c != EOF)
+        ungetc(c, inputFile);
+    return used;
+}
+
+// This function reads one more number from inputFile, such as a size some formats keep after the
+// dimensions, exactly as a dimension of the header is read. The file is left just after it.
+// It returns 0 when there is no number there.
+int readImageDimension(FILE *inputFile, int *dimension)
+{
+    unsigned char prefix[IMAGE_HEADER_PREFIX];
+    size_t used = 0, position = 0;
+    int c = getc(inputFile);
+    gatherImageDimension(inputFile, prefix, &used, &c);
+    if (c != EOF)
+        ungetc(c, inputFile);
+    return scanImageDimension(prefix, used, &position, dimension);
+}
+
+// This function reads the magic number and dimensions at the start of inputFile and checks them.
+// The header is gathered into a short buffer and parsed there rather than with fscanf.
+// The file is left just after the width, and nothing is printed.
+int readImageHeader(FILE *inputFile, struct ImageFileInfo *imageFileInfo, unsigned short magicNumber)
+{
+    unsigned char prefix[IMAGE_HEADER_PREFIX];
+    size_t position;
+    size_t length = gatherImageHeader(inputFile, prefix);
+    return parseImageHeader(prefix, length, &position, imageFileInfo, magicNumber);
+}
+
+// This function prints the usual message for an error code returned by one of the library functions.
+void reportImageError(int check, const char *fileName)
+{
+    if (check == BAD_FILE)
+        printf("ERROR: Bad File Name (%s)\n", fileName);
+    else if (check == BAD_MAGIC_NUMBER)
+        printf("ERROR: Bad Magic Number (%s)\n", fileName);
+    else if (check == BAD_DIM)
+        printf("ERROR: Bad Dimensions (%s)\n", fileName);
+    else if (check == BAD_MALLOC)
+        printf("ERROR: Image Malloc Failed\n");
+    else if (check == BAD_DATA)
+        printf("ERROR: Bad Data (%s)\n", fileName);
+    else if (check == BAD_OUTPUT)
+        printf("ERROR: Bad Output\n");
+}
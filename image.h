@@ -0,0 +1,86 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SUCCESS 0
+#define BAD_ARGS 1
+#define BAD_FILE 2
+#define BAD_MAGIC_NUMBER 3
+#define BAD_DIM 4
+#define BAD_MALLOC 5
+#define BAD_DATA 6
+#define BAD_OUTPUT 7
+#define MAX_DIMENSION 262144
+#define MIN_DIMENSION 1
+
+// The first two bytes of each format, read as a little endian short.
+#define MAGIC_NUMBER_EBF 0x6265
+#define MAGIC_NUMBER_EBU 0x7565
+#define MAGIC_NUMBER_EBC 0x6365
+#define MAGIC_NUMBER_EBT 0x7465
+#define MAGIC_NUMBER_EBZ 0x7A65
+
+// Every pixel buffer starts on a cache line so that rows can be walked with aligned loads.
+#define IMAGE_ALIGNMENT 64
+
+// The most bytes a header is gathered into before it is parsed: the magic number and, for each
+// dimension, one space, a sign and ten significant digits.
+#define IMAGE_HEADER_PREFIX 32
+
+typedef struct ImageFileInfo
+{
+    unsigned char magicNumber[2];
+    unsigned short *magicNumberValue;
+
+    // Dimensions of the image and the distance in bytes between the starts of two rows.
+    int width, height;
+    long stride;
+    // All pixel values live in one contiguous block, row after row.
+    unsigned char *imageData;
+    long numBytes;
+    // Set when imageData is a copy-on-write view into a mapped file rather than a block of its own.
+    void *mapping;
+    size_t mappingLength;
+    // Size of the block imageData was checked out of the image arena as.
+    size_t blockCapacity;
+} ImageFileInfo;
+
+// This function sets up an empty image so that it can be safely read into or cleared.
+void initImageFileInfo(struct ImageFileInfo *imageFileInfo);
+
+// This function returns a pointer to the first pixel of the given row.
+static inline unsigned char *imageRow(const struct ImageFileInfo *imageFileInfo, long row)
+{
+    return imageFileInfo->imageData + row * imageFileInfo->stride;
+}
+
+// This function works out the size of an image in 64 bits, returning BAD_MALLOC when it does not fit.
+int countImageBytes(int height, int width, long *numBytes);
+
+// This function allocates the pixel block for the dimensions already stored in the image.
+int allocateImageData(struct ImageFileInfo *imageFileInfo);
+
+// This function gives imageData back to the image arena, or unmaps the file it is a view into.
+void clearImageData(struct ImageFileInfo *imageFileInfo);
+
+// This function copies an image which is a view into a mapped file into a block of its own.
+int detachImageData(struct ImageFileInfo *imageFileInfo);
+
+// This function checks the magic number and dimensions of a header and works out the size of the image.
+int checkImageHeader(struct ImageFileInfo *imageFileInfo, unsigned short magicNumber);
+
+// This function parses and checks the header at the start of a buffer, leaving position after the width.
+int parseImageHeader(const unsigned char *bytes, size_t length, size_t *position, struct ImageFileInfo *imageFileInfo, unsigned short magicNumber);
+
+// This function reads and checks the header at the start of an image file.
+int readImageHeader(FILE *inputFile, struct ImageFileInfo *imageFileInfo, unsigned short magicNumber);
+
+// This function reads one more number after the header the way a dimension is read, and returns 0 when there is none.
+int readImageDimension(FILE *inputFile, int *dimension);
+
+// This function prints the usual message for an error code.
+void reportImageError(int check, const char *fileName);
+
+#endif
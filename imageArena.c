@@ -0,0 +1,178 @@
+// madvise and MAP_ANONYMOUS are only declared for the default feature set
+#define _DEFAULT_SOURCE
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include "image.h"
+#include "imageArena.h"
+
+// The blocks a thread has been given back, by class. Each list is linked through the first word of its
+// blocks, which are not in use, so keeping a block costs nothing beyond the block itself.
+typedef struct ImageArenaPool
+{
+    void *blocks[IMAGE_ARENA_CLASSES];
+    int counts[IMAGE_ARENA_CLASSES];
+    size_t bytes;
+} ImageArenaPool;
+
+static __thread ImageArenaPool *threadPool = NULL;
+static pthread_key_t poolKey;
+static pthread_once_t poolKeyOnce = PTHREAD_ONCE_INIT;
+
+// This function returns the class of a block of at least size bytes and sets capacity to its size.
+// The capacity is the power of two below size plus the next whole quarter of it.
+static int findArenaClass(size_t size, size_t *capacity)
+{
+    if (size < IMAGE_ARENA_MIN_BLOCK)
+        size = IMAGE_ARENA_MIN_BLOCK;
+    int power = 63 - __builtin_clzll((unsigned long long)(size - 1));
+    size_t base = (size_t)1 << power, step = base / IMAGE_ARENA_STEPS;
+    size_t steps = (size - base + step - 1) / step;
+    *capacity = base + steps * step;
+    return power * IMAGE_ARENA_STEPS + (int)steps - 1;
+}
+
+// This function returns the size of the blocks of a class.
+static size_t arenaClassCapacity(int index)
+{
+    size_t step = ((size_t)1 << index / IMAGE_ARENA_STEPS) / IMAGE_ARENA_STEPS;
+    return step * (IMAGE_ARENA_STEPS + index % IMAGE_ARENA_STEPS + 1);
+}
+
+// This function returns the length of the mapping behind a huge block of the given capacity.
+static size_t hugeArenaLength(size_t capacity)
+{
+    return (capacity + IMAGE_ARENA_HUGE_PAGE - 1) / IMAGE_ARENA_HUGE_PAGE * IMAGE_ARENA_HUGE_PAGE;
+}
+
+// This function makes a new block of the given capacity.
+// A huge block is mapped a huge page too long and trimmed so that it starts on a huge page.
+static void *makeArenaBlock(size_t capacity)
+{
+    if (capacity < IMAGE_ARENA_HUGE_PAGE)
+    {
+        void *block = NULL;
+        return posix_memalign(&block, IMAGE_ALIGNMENT, capacity) == 0 ? block : NULL;
+    }
+
+    size_t length = hugeArenaLength(capacity);
+    if (length < capacity || length + IMAGE_ARENA_HUGE_PAGE < length)
+        return NULL;
+    unsigned char *mapping = (unsigned char *)mmap(NULL, length + IMAGE_ARENA_HUGE_PAGE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED)
+        return NULL;
+    size_t head = (IMAGE_ARENA_HUGE_PAGE - (uintptr_t)mapping % IMAGE_ARENA_HUGE_PAGE) % IMAGE_ARENA_HUGE_PAGE;
+    if (head > 0)
+        munmap(mapping, head);
+    munmap(mapping + head + length, IMAGE_ARENA_HUGE_PAGE - head);
+#ifdef MADV_HUGEPAGE
+    madvise(mapping + head, length, MADV_HUGEPAGE);
+#endif
+    return mapping + head;
+}
+
+// This function frees a block for good.
+static void freeArenaBlock(void *block, size_t capacity)
+{
+    if (capacity < IMAGE_ARENA_HUGE_PAGE)
+        free(block);
+    else
+        munmap(block, hugeArenaLength(capacity));
+}
+
+// This function frees every block in a pool, leaving it empty.
+static void emptyArenaPool(struct ImageArenaPool *pool)
+{
+    for (int index = 0; index < IMAGE_ARENA_CLASSES; index++)
+    {
+        size_t capacity = arenaClassCapacity(index);
+        while (pool->blocks[index] != NULL)
+        {
+            void *block = pool->blocks[index];
+            pool->blocks[index] = *(void **)block;
+            freeArenaBlock(block, capacity);
+        }
+        pool->counts[index] = 0;
+    }
+    pool->bytes = 0;
+}
+
+// This function frees the pool of a thread which is exiting.
+static void freeArenaPool(void *pool)
+{
+    emptyArenaPool((struct ImageArenaPool *)pool);
+    free(pool);
+}
+
+// This function creates the key whose destructor frees each thread's pool.
+static void createArenaKey(void)
+{
+    pthread_key_create(&poolKey, freeArenaPool);
+}
+
+// This function returns the calling thread's pool, creating it the first time, or NULL when memory runs out.
+static struct ImageArenaPool *findArenaPool(void)
+{
+    if (threadPool != NULL)
+        return threadPool;
+    pthread_once(&poolKeyOnce, createArenaKey);
+    threadPool = (struct ImageArenaPool *)calloc(1, sizeof(struct ImageArenaPool));
+    if (threadPool != NULL)
+        pthread_setspecific(poolKey, threadPool);
+    return threadPool;
+}
+
+// This function returns a block of at least size bytes aligned to a cache line, or NULL when memory runs out.
+// A block of the same class given back to this thread is reused, so a process which handles image after
+// image of similar sizes stops allocating, and the pages of a reused block are already resident.
+void *checkOutImageBlock(size_t size, size_t *capacity)
+{
+    if (size > SIZE_MAX / 2)
+        return NULL;
+    int index = findArenaClass(size, capacity);
+    struct ImageArenaPool *pool = findArenaPool();
+    if (pool != NULL && pool->blocks[index] != NULL)
+    {
+        void *block = pool->blocks[index];
+        pool->blocks[index] = *(void **)block;
+        pool->counts[index]--;
+        pool->bytes -= *capacity;
+        return block;
+    }
+    return makeArenaBlock(*capacity);
+}
+
+// This function gives a block back to the calling thread's pool, or frees it when the pool is full.
+// It may be given back on a different thread from the one it was checked out on.
+void returnImageBlock(void *block, size_t capacity)
+{
+    if (block == NULL)
+        return;
+    size_t classCapacity;
+    int index = findArenaClass(capacity, &classCapacity);
+    struct ImageArenaPool *pool = findArenaPool();
+    if (pool == NULL || pool->counts[index] >= IMAGE_ARENA_KEEP_BLOCKS || pool->bytes + capacity > IMAGE_ARENA_KEEP_BYTES)
+    {
+        freeArenaBlock(block, capacity);
+        return;
+    }
+    *(void **)block = pool->blocks[index];
+    pool->blocks[index] = block;
+    pool->counts[index]++;
+    pool->bytes += capacity;
+}
+
+// This function frees every block held by the calling thread's pool.
+void releaseImageArena(void)
+{
+    if (threadPool != NULL)
+        emptyArenaPool(threadPool);
+}
+
+// This function returns the number of bytes held by the calling thread's pool.
+size_t imageArenaBytes(void)
+{
+    return threadPool != NULL ? threadPool->bytes : 0;
+}
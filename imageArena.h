@@ -0,0 +1,35 @@
+#ifndef IMAGE_ARENA_H
+#define IMAGE_ARENA_H
+
+#include <stddef.h>
+
+// Blocks are handed out in size classes, four to every power of two, so a block is never more than a
+// quarter larger than was asked for and a returned block fits the next image of about the same size.
+#define IMAGE_ARENA_STEPS 4
+#define IMAGE_ARENA_CLASSES (64 * IMAGE_ARENA_STEPS)
+
+// No block is smaller than this.
+#define IMAGE_ARENA_MIN_BLOCK (1 << 12)
+
+// Blocks of at least this many bytes are mapped on their own, aligned to and in multiples of a huge page,
+// and the kernel is asked to back them with huge pages. Smaller ones come from the heap.
+#define IMAGE_ARENA_HUGE_PAGE (1 << 21)
+
+// Each thread keeps at most this many returned blocks of one class, and this many bytes in all.
+#define IMAGE_ARENA_KEEP_BLOCKS 4
+#define IMAGE_ARENA_KEEP_BYTES (1L << 30)
+
+// This function returns a block of at least size bytes aligned to a cache line, or NULL when memory runs out.
+// capacity is set to the size of the block, which must be given back with it.
+void *checkOutImageBlock(size_t size, size_t *capacity);
+
+// This function gives a block back to the calling thread's pool, or frees it when the pool is full.
+void returnImageBlock(void *block, size_t capacity);
+
+// This function frees every block held by the calling thread's pool.
+void releaseImageArena(void);
+
+// This function returns the number of bytes held by the calling thread's pool.
+size_t imageArenaBytes(void);
+
+#endif
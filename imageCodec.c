@@ -0,0 +1,55 @@
+#include <stdio.h>
+#include <string.h>
+#include "image.h"
+#include "imageCodec.h"
+
+// Every format the library knows.
+static const struct ImageCodec *const imageCodecs[] = {&ebfCodec, &ebuCodec, &ebcCodec, &ebtCodec, &ebzCodec};
+#define IMAGE_CODEC_COUNT (sizeof(imageCodecs) / sizeof(imageCodecs[0]))
+
+// This function returns the codec for a magic number, or NULL when it is not one of the formats.
+const struct ImageCodec *findImageCodec(unsigned short magicNumber)
+{
+    for (size_t index = 0; index < IMAGE_CODEC_COUNT; index++)
+        if (imageCodecs[index]->magicNumber == magicNumber)
+            return imageCodecs[index];
+    return NULL;
+}
+
+// This function returns the codec for an extension such as "ebf", or NULL.
+const struct ImageCodec *findImageCodecByName(const char *name)
+{
+    for (size_t index = 0; index < IMAGE_CODEC_COUNT; index++)
+        if (strcmp(imageCodecs[index]->name, name) == 0)
+            return imageCodecs[index];
+    return NULL;
+}
+
+// This function returns the codec named by the extension of fileName, or NULL.
+const struct ImageCodec *findImageCodecByExtension(const char *fileName)
+{
+    const char *extension = strrchr(fileName, '.');
+    if (extension == NULL || strchr(extension, '/') != NULL)
+        return NULL;
+    return findImageCodecByName(extension + 1);
+}
+
+// This function works out the format of an image file from its magic number.
+// It returns NULL and sets check to BAD_FILE or BAD_MAGIC_NUMBER when the file is not an image.
+const struct ImageCodec *detectImageCodec(const char *fileName, int *check)
+{
+    FILE *inputFile = fopen(fileName, "rb");
+    if (inputFile == NULL)
+    {
+        *check = BAD_FILE;
+        return NULL;
+    }
+    unsigned char magicNumber[2] = {0, 0};
+    size_t got = fread(magicNumber, 1, 2, inputFile);
+    fclose(inputFile);
+
+    const struct ImageCodec *codec = got == 2 ? findImageCodec((unsigned short)(magicNumber[0] | magicNumber[1] << 8)) : NULL;
+    if (codec == NULL)
+        *check = BAD_MAGIC_NUMBER;
+    return codec;
+}
@@ -0,0 +1,48 @@
+#ifndef IMAGE_CODEC_H
+#define IMAGE_CODEC_H
+
+struct ImageReader;
+struct ImageWriter;
+
+// A codec is everything that differs between the formats once the header has been read or written.
+// The readers, writers and every tool go through these functions, so a format is only written once.
+typedef struct ImageCodec
+{
+    // Extension and magic number of the format.
+    const char *name;
+    unsigned short magicNumber;
+
+    // Sets up a reader whose header has just been read, allocating any block it does not have yet.
+    int (*startReader)(struct ImageReader *reader);
+    // Reads the next count pixels, which the reader has checked are not more than are left.
+    int (*readPixels)(struct ImageReader *reader, unsigned char *pixels, long count);
+    // Checks that nothing but the allowed padding follows the last pixel.
+    int (*finishReader)(struct ImageReader *reader);
+
+    // Allocates any block a writer does not have yet, before its file is created.
+    int (*startWriter)(struct ImageWriter *writer);
+    // Writes the next count pixels.
+    int (*writePixels)(struct ImageWriter *writer, const unsigned char *pixels, long count);
+    // Moves anything the codec still holds into the writer's buffer.
+    int (*finishWriter)(struct ImageWriter *writer);
+} ImageCodec;
+
+extern const struct ImageCodec ebfCodec;
+extern const struct ImageCodec ebuCodec;
+extern const struct ImageCodec ebcCodec;
+extern const struct ImageCodec ebtCodec;
+extern const struct ImageCodec ebzCodec;
+
+// This function returns the codec for a magic number, or NULL when it is not one of the formats.
+const struct ImageCodec *findImageCodec(unsigned short magicNumber);
+
+// This function returns the codec for an extension such as "ebf", or NULL.
+const struct ImageCodec *findImageCodecByName(const char *name);
+
+// This function returns the codec named by the extension of fileName, or NULL.
+const struct ImageCodec *findImageCodecByExtension(const char *fileName);
+
+// This function returns the codec for the magic number at the start of fileName.
+const struct ImageCodec *detectImageCodec(const char *fileName, int *check);
+
+#endif
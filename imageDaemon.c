@@ -0,0 +1,287 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include "image.h"
+#include "imageDaemon.h"
+#include "imageHash.h"
+#include "streamComp.h"
+#include "streamConvert.h"
+
+// What an image tool does with its arguments.
+#define IMAGE_TOOL_CONVERT 0
+#define IMAGE_TOOL_ECHO 1
+#define IMAGE_TOOL_COMPARE 2
+#define IMAGE_TOOL_TRANSCODE 3
+#define IMAGE_TOOL_HASH 4
+
+// One of the tools the daemon runs, with the formats its executable is fixed to.
+typedef struct ImageTool
+{
+    const char *name;
+    int kind;
+    unsigned short inputMagic, outputMagic;
+} ImageTool;
+
+static const struct ImageTool imageTools[] = {
+    {"ebf2ebu", IMAGE_TOOL_CONVERT, MAGIC_NUMBER_EBF, MAGIC_NUMBER_EBU},
+    {"ebu2ebf", IMAGE_TOOL_CONVERT, MAGIC_NUMBER_EBU, MAGIC_NUMBER_EBF},
+    {"ebc2ebu", IMAGE_TOOL_CONVERT, MAGIC_NUMBER_EBC, MAGIC_NUMBER_EBU},
+    {"ebu2ebc", IMAGE_TOOL_CONVERT, MAGIC_NUMBER_EBU, MAGIC_NUMBER_EBC},
+    {"ebfEcho", IMAGE_TOOL_ECHO, MAGIC_NUMBER_EBF, MAGIC_NUMBER_EBF},
+    {"ebuEcho", IMAGE_TOOL_ECHO, MAGIC_NUMBER_EBU, MAGIC_NUMBER_EBU},
+    {"ebcEcho", IMAGE_TOOL_ECHO, MAGIC_NUMBER_EBC, MAGIC_NUMBER_EBC},
+    {"ebfComp", IMAGE_TOOL_COMPARE, MAGIC_NUMBER_EBF, 0},
+    {"ebuComp", IMAGE_TOOL_COMPARE, MAGIC_NUMBER_EBU, 0},
+    {"ebcComp", IMAGE_TOOL_COMPARE, MAGIC_NUMBER_EBC, 0},
+    {"ebComp", IMAGE_TOOL_COMPARE, 0, 0},
+    {"ebconvert", IMAGE_TOOL_TRANSCODE, 0, 0},
+    {"ebhash", IMAGE_TOOL_HASH, 0, 0}};
+
+// This function runs one of the image tools, by name, exactly as its own executable would:
+// the same usage line, argument checks, messages and return code.
+int runImageTool(int argc, char **argv)
+{
+    const struct ImageTool *tool = NULL;
+    for (size_t index = 0; index < sizeof(imageTools) / sizeof(imageTools[0]); index++)
+    {
+        if (argc > 0 && strcmp(argv[0], imageTools[index].name) == 0)
+            tool = &imageTools[index];
+    }
+    if (tool == NULL)
+    {
+        printf("ERROR: Bad Arguments\n");
+        return BAD_ARGS;
+    }
+
+    if (argc == 1)
+    {
+        printf(tool->kind == IMAGE_TOOL_HASH ? "Usage: %s file" : "Usage: %s file1 file2", tool->name);
+        return SUCCESS;
+    }
+    // the comp tools take --hash, --cache or --stats, and ebhash --cache, before their files
+    int mode = tool->kind == IMAGE_TOOL_COMPARE && argc == 4 ? findCompareMode(argv[1]) : COMPARE_PIXELS;
+    int cache = tool->kind == IMAGE_TOOL_HASH && argc == 3 && strcmp(argv[1], "--cache") == 0;
+    int arguments = tool->kind == IMAGE_TOOL_HASH ? 2 + cache : tool->kind == IMAGE_TOOL_COMPARE && argc == 4 ? 4 : 3;
+    if (argc != arguments || mode < 0) // check arg count
+    {
+        printf("ERROR: Bad Arguments\n");
+        return BAD_ARGS;
+    }
+
+    if (tool->kind == IMAGE_TOOL_CONVERT)
+        return convertImageFile(argv[1], tool->inputMagic, argv[2], tool->outputMagic);
+    if (tool->kind == IMAGE_TOOL_ECHO)
+        return echoImageFile(argv[1], argv[2], tool->inputMagic);
+    if (tool->kind == IMAGE_TOOL_COMPARE)
+        return compareImagesBy(argv[argc - 2], argv[argc - 1], tool->inputMagic, mode);
+    if (tool->kind == IMAGE_TOOL_TRANSCODE)
+        return transcodeImageFile(argv[1], argv[2]);
+    return printImageHash(argv[argc - 1], cache);
+}
+
+// This function fills in the address of the socket at socketPath, returning 0 when the path is too long.
+static int makeDaemonAddress(const char *socketPath, struct sockaddr_un *address)
+{
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+    if (strlen(socketPath) >= sizeof(address->sun_path))
+        return 0;
+    strcpy(address->sun_path, socketPath);
+    return 1;
+}
+
+// This function reads from a connection until the other end stops writing or size bytes have come.
+// It returns the number of bytes read, or -1 when the connection fails.
+static long readDaemonBytes(int connection, char *bytes, size_t size)
+{
+    size_t used = 0;
+    while (used < size)
+    {
+        ssize_t got = read(connection, bytes + used, size - used);
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got < 0)
+            return -1;
+        if (got == 0)
+            break;
+        used += (size_t)got;
+    }
+    return (long)used;
+}
+
+// This function runs the request on one connection and answers it. The request is the client's working
+// directory followed by the tool's arguments, each ended by a zero byte. The answer is everything the tool
+// printed, a zero byte and the return code as one byte. The tool prints straight into the connection,
+// which stands in for standard output while it runs, so requests are run one at a time.
+static void answerDaemonRequest(int connection, char *request)
+{
+    long length = readDaemonBytes(connection, request, IMAGE_DAEMON_REQUEST);
+    if (length <= 0 || length == IMAGE_DAEMON_REQUEST || request[length - 1] != '\0')
+        return;
+
+    char *fields[IMAGE_DAEMON_FIELDS];
+    int fieldCount = 0;
+    for (long at = 0; at < length && fieldCount < IMAGE_DAEMON_FIELDS; at += (long)strlen(request + at) + 1)
+        fields[fieldCount++] = request + at;
+
+    fflush(stdout);
+    int console = dup(STDOUT_FILENO);
+    if (console < 0 || dup2(connection, STDOUT_FILENO) < 0)
+    {
+        if (console >= 0)
+            close(console);
+        return;
+    }
+
+    int check = BAD_ARGS;
+    if (fieldCount < 2 || fieldCount == IMAGE_DAEMON_FIELDS)
+        printf("ERROR: Bad Arguments\n");
+    else if (chdir(fields[0]) != 0)
+    {
+        reportImageError(BAD_FILE, fields[0]);
+        check = BAD_FILE;
+    }
+    else
+        check = runImageTool(fieldCount - 1, fields + 1);
+
+    fflush(stdout);
+    dup2(console, STDOUT_FILENO);
+    close(console);
+    unsigned char trailer[2] = {0, (unsigned char)check};
+    writeAllBytes(connection, trailer, sizeof(trailer));
+}
+
+// This function waits out a failed accept. It returns 0 when the listener itself has failed, and otherwise
+// 1 once it is worth accepting again: straight away when the connection was lost before it was accepted, or
+// after a pause, doubled from the last one, when the daemon is out of file descriptors or memory, which
+// only finishing requests can free.
+static int pauseDaemonAccept(long *pause)
+{
+    if (errno == EINTR || errno == ECONNABORTED || errno == EPROTO)
+        return 1;
+    if (errno != EMFILE && errno != ENFILE && errno != ENOBUFS && errno != ENOMEM)
+        return 0;
+    *pause = *pause == 0 ? IMAGE_DAEMON_MIN_PAUSE : *pause * 2;
+    if (*pause > IMAGE_DAEMON_MAX_PAUSE)
+        *pause = IMAGE_DAEMON_MAX_PAUSE;
+    struct timespec wait = {*pause / 1000, *pause % 1000 * 1000000L};
+    while (nanosleep(&wait, &wait) != 0 && errno == EINTR)
+        ;
+    return 1;
+}
+
+// This function listens on socketPath and runs tool requests one after another until it is killed.
+// The task pool and each image arena stay warm from one request to the next, so a small image costs
+// a connection rather than starting a process. A socket left behind by an earlier daemon is replaced.
+// A client gets IMAGE_DAEMON_TIMEOUT seconds for each read and write, after which its request is dropped.
+// It returns BAD_FILE when the socket cannot be made or stops accepting, or BAD_MALLOC.
+int serveImageDaemon(const char *socketPath)
+{
+    struct sockaddr_un address;
+    struct stat status;
+    if (!makeDaemonAddress(socketPath, &address))
+        return BAD_FILE;
+    if (lstat(socketPath, &status) == 0 && S_ISSOCK(status.st_mode))
+        unlink(socketPath);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0 || bind(listener, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(listener, IMAGE_DAEMON_BACKLOG) != 0)
+    {
+        if (listener >= 0)
+            close(listener);
+        return BAD_FILE;
+    }
+    char *request = (char *)malloc(IMAGE_DAEMON_REQUEST);
+    if (request == NULL)
+    {
+        close(listener);
+        return BAD_MALLOC;
+    }
+
+    // a client which goes away before its answer is written must not stop the daemon
+    signal(SIGPIPE, SIG_IGN);
+    struct timeval timeout = {IMAGE_DAEMON_TIMEOUT, 0};
+    long pause = 0;
+    for (;;)
+    {
+        int connection = accept(listener, NULL, NULL);
+        if (connection < 0)
+        {
+            if (pauseDaemonAccept(&pause))
+                continue;
+            free(request);
+            close(listener);
+            return BAD_FILE;
+        }
+        pause = 0;
+        // a read or write which times out fails like a lost connection, and the request is dropped
+        if (setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) == 0 &&
+            setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) == 0)
+            answerDaemonRequest(connection, request);
+        close(connection);
+    }
+}
+
+// This function has the daemon at socketPath run a tool in the current directory, given its arguments
+// as its own executable would be. It prints what the tool printed and returns its return code, so a
+// client behaves just like the tool. It returns BAD_FILE when the daemon cannot be reached.
+int requestImageDaemon(const char *socketPath, int argc, char **argv)
+{
+    struct sockaddr_un address;
+    int connection = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connection < 0 || !makeDaemonAddress(socketPath, &address) || connect(connection, (struct sockaddr *)&address, sizeof(address)) != 0)
+    {
+        if (connection >= 0)
+            close(connection);
+        reportImageError(BAD_FILE, socketPath);
+        return BAD_FILE;
+    }
+
+    // the request is the working directory and the arguments, each ended by a zero byte
+    char *buffer = (char *)malloc(IMAGE_DAEMON_REQUEST);
+    size_t used = 0;
+    int check = buffer == NULL ? BAD_MALLOC : SUCCESS;
+    if (check == SUCCESS && getcwd(buffer, IMAGE_DAEMON_REQUEST) == NULL)
+        check = BAD_ARGS;
+    if (check == SUCCESS)
+        used = strlen(buffer) + 1;
+    for (int index = 0; index < argc && check == SUCCESS; index++)
+    {
+        size_t size = strlen(argv[index]) + 1;
+        if (size > IMAGE_DAEMON_REQUEST - used)
+            check = BAD_ARGS;
+        else
+        {
+            memcpy(buffer + used, argv[index], size);
+            used += size;
+        }
+    }
+    if (check == SUCCESS && writeAllBytes(connection, (const unsigned char *)buffer, used) != SUCCESS)
+        check = BAD_FILE;
+    shutdown(connection, SHUT_WR);
+
+    // the answer is the tool's output, a zero byte and the return code
+    long length = check == SUCCESS ? readDaemonBytes(connection, buffer, IMAGE_DAEMON_REQUEST) : -1;
+    close(connection);
+    if (check == SUCCESS && (length < 2 || buffer[length - 2] != '\0'))
+        check = BAD_FILE;
+    if (check == SUCCESS)
+    {
+        fwrite(buffer, 1, (size_t)length - 2, stdout);
+        check = (unsigned char)buffer[length - 1];
+    }
+    else if (check == BAD_ARGS)
+        printf("ERROR: Bad Arguments\n");
+    else
+        reportImageError(check, socketPath);
+    free(buffer);
+    return check;
+}
@@ -0,0 +1,32 @@
+#ifndef IMAGE_DAEMON_H
+#define IMAGE_DAEMON_H
+
+// Most bytes of one request: the client's working directory, the tool name and its arguments,
+// each ended by a zero byte.
+#define IMAGE_DAEMON_REQUEST (1 << 16)
+
+// Most fields of one request.
+#define IMAGE_DAEMON_FIELDS 16
+
+// Connections waiting to be accepted.
+#define IMAGE_DAEMON_BACKLOG 64
+
+// Seconds the daemon waits on a client which stops sending its request or reading its answer, so that
+// one stalled client cannot hold up the clients queued behind it.
+#define IMAGE_DAEMON_TIMEOUT 5
+
+// Shortest and longest pause, in milliseconds, before accepting again while the daemon is out of
+// file descriptors or memory. The pause doubles each time accepting fails.
+#define IMAGE_DAEMON_MIN_PAUSE 10
+#define IMAGE_DAEMON_MAX_PAUSE 1000
+
+// This function runs one of the image tools, by name, exactly as its own executable would.
+int runImageTool(int argc, char **argv);
+
+// This function listens on socketPath and runs tool requests one after another until it is killed or the socket fails.
+int serveImageDaemon(const char *socketPath);
+
+// This function has the daemon at socketPath run a tool, printing its output and returning its return code.
+int requestImageDaemon(const char *socketPath, int argc, char **argv);
+
+#endif
@@ -0,0 +1,319 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include "imageHash.h"
+#include "imageKernel.h"
+#include "imageStream.h"
+
+#ifdef HASH_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+// The fixed secret each stripe is mixed with. Stripe n of a block takes the eight words from word n,
+// the lanes are scrambled with the last eight words and merged with the eight from word 11.
+static const uint64_t hashSecret[HASH_BLOCK_STRIPES + HASH_LANES] = {
+    0x5F13E3D68D745112ULL, 0xE81D1F804D770331ULL, 0x0626B53EFA1B7567ULL, 0x0DA2CCFE6F0A601FULL,
+    0xCB5DB0CD85522E7CULL, 0xB4731D1B2ACB3E83ULL, 0xE2FA93C7821D714CULL, 0x4B9915AAE28B21C2ULL,
+    0x1837769938CBAD50ULL, 0x00345CED803AB740ULL, 0xF9B2C95FE47511BEULL, 0x12D6A34FDAD65578ULL,
+    0xFA43C138F882B8BEULL, 0xAAB95341DEE0C76CULL, 0x7E30403348977C0CULL, 0xD4CA1D4BCEF2B39AULL,
+    0x396C659E81B7EEEAULL, 0x48EFF27A05B30CBEULL, 0x37565D4812D894EEULL, 0xCD39CEB3FCB709A8ULL,
+    0x5FD984D4231EF9E0ULL, 0xEAF641EE94C188ABULL, 0xD0D428CBA2AFBD79ULL, 0xD77C8130F62BD0C7ULL};
+#define HASH_SCRAMBLE_WORD HASH_BLOCK_STRIPES
+#define HASH_MERGE_WORD 11
+
+// The primes of xxHash, which the lanes start from and the result is mixed with.
+#define HASH_PRIME32_1 0x9E3779B1ULL
+#define HASH_PRIME32_2 0x85EBCA77ULL
+#define HASH_PRIME32_3 0xC2B2AE3DULL
+#define HASH_PRIME64_1 0x9E3779B185EBCA87ULL
+#define HASH_PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define HASH_PRIME64_3 0x165667B19E3779F9ULL
+#define HASH_PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define HASH_PRIME64_5 0x27D4EB2F165667C5ULL
+
+// This function loads 8 bytes as a little endian word.
+static inline uint64_t loadHashWord(const unsigned char *bytes)
+{
+    uint64_t word;
+    memcpy(&word, bytes, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+}
+
+// This function adds stripes one word at a time. Each word is added to its neighbouring lane, and
+// the product of its two halves, once mixed with the secret, to its own.
+void accumulateHashScalar(uint64_t *lanes, const unsigned char *stripes, long count)
+{
+    for (long stripe = 0; stripe < count; stripe++)
+    {
+        for (int lane = 0; lane < HASH_LANES; lane++)
+        {
+            uint64_t word = loadHashWord(stripes + stripe * HASH_STRIPE_BYTES + 8 * lane);
+            uint64_t keyed = word ^ hashSecret[stripe + lane];
+            lanes[lane ^ 1] += word;
+            lanes[lane] += (keyed & 0xFFFFFFFF) * (keyed >> 32);
+        }
+    }
+}
+
+#ifdef HASH_X86_KERNELS
+// This function adds stripes two lanes at a time with SSE2.
+void accumulateHashSse2(uint64_t *lanes, const unsigned char *stripes, long count)
+{
+    __m128i sums[HASH_LANES / 2];
+    for (int pair = 0; pair < HASH_LANES / 2; pair++)
+        sums[pair] = _mm_loadu_si128((const __m128i *)(lanes + 2 * pair));
+    for (long stripe = 0; stripe < count; stripe++)
+    {
+        for (int pair = 0; pair < HASH_LANES / 2; pair++)
+        {
+            __m128i words = _mm_loadu_si128((const __m128i *)(stripes + stripe * HASH_STRIPE_BYTES + 16 * pair));
+            __m128i keyed = _mm_xor_si128(words, _mm_loadu_si128((const __m128i *)(hashSecret + stripe + 2 * pair)));
+            __m128i product = _mm_mul_epu32(keyed, _mm_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1)));
+            sums[pair] = _mm_add_epi64(sums[pair], _mm_add_epi64(product, _mm_shuffle_epi32(words, _MM_SHUFFLE(1, 0, 3, 2))));
+        }
+    }
+    for (int pair = 0; pair < HASH_LANES / 2; pair++)
+        _mm_storeu_si128((__m128i *)(lanes + 2 * pair), sums[pair]);
+}
+
+// This function adds stripes four lanes at a time with AVX2.
+__attribute__((target("avx2"))) void accumulateHashAvx2(uint64_t *lanes, const unsigned char *stripes, long count)
+{
+    __m256i sums[HASH_LANES / 4];
+    for (int quad = 0; quad < HASH_LANES / 4; quad++)
+        sums[quad] = _mm256_loadu_si256((const __m256i *)(lanes + 4 * quad));
+    for (long stripe = 0; stripe < count; stripe++)
+    {
+        for (int quad = 0; quad < HASH_LANES / 4; quad++)
+        {
+            __m256i words = _mm256_loadu_si256((const __m256i *)(stripes + stripe * HASH_STRIPE_BYTES + 32 * quad));
+            __m256i keyed = _mm256_xor_si256(words, _mm256_loadu_si256((const __m256i *)(hashSecret + stripe + 4 * quad)));
+            __m256i product = _mm256_mul_epu32(keyed, _mm256_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1)));
+            sums[quad] = _mm256_add_epi64(sums[quad], _mm256_add_epi64(product, _mm256_shuffle_epi32(words, _MM_SHUFFLE(1, 0, 3, 2))));
+        }
+    }
+    for (int quad = 0; quad < HASH_LANES / 4; quad++)
+        _mm256_storeu_si256((__m256i *)(lanes + 4 * quad), sums[quad]);
+}
+#endif
+
+static ImageHashKernel hashKernel = NULL;
+static pthread_once_t hashKernelOnce = PTHREAD_ONCE_INIT;
+
+// This function picks the fastest kernel the processor supports, or the one HASH_KERNEL forces.
+static void pickHashKernel(void)
+{
+    hashKernel = accumulateHashScalar;
+#ifdef HASH_X86_KERNELS
+    const ImageHashKernel kernels[] = {accumulateHashScalar, accumulateHashSse2, accumulateHashAvx2};
+    hashKernel = kernels[pickImageKernel("HASH_KERNEL")];
+#endif
+}
+
+// This function picks the kernel the first time any thread calls it.
+void selectHashKernel(void)
+{
+    pthread_once(&hashKernelOnce, pickHashKernel);
+}
+
+// This function scrambles the lanes at the end of a block.
+static void scrambleHashLanes(uint64_t *lanes)
+{
+    for (int lane = 0; lane < HASH_LANES; lane++)
+    {
+        uint64_t value = lanes[lane] ^ (lanes[lane] >> 47);
+        lanes[lane] = (value ^ hashSecret[HASH_SCRAMBLE_WORD + lane]) * HASH_PRIME32_1;
+    }
+}
+
+// This function multiplies two words into 128 bits and folds the halves together.
+static uint64_t foldHashProduct(uint64_t first, uint64_t second)
+{
+    uint64_t firstLow = first & 0xFFFFFFFF, firstHigh = first >> 32, secondLow = second & 0xFFFFFFFF, secondHigh = second >> 32;
+    uint64_t lowLow = firstLow * secondLow, lowHigh = firstLow * secondHigh, highLow = firstHigh * secondLow;
+    uint64_t cross = (lowLow >> 32) + (lowHigh & 0xFFFFFFFF) + highLow;
+    uint64_t upper = firstHigh * secondHigh + (lowHigh >> 32) + (cross >> 32);
+    return ((cross << 32) | (lowLow & 0xFFFFFFFF)) ^ upper;
+}
+
+// This function starts the hash of a new image.
+void startImageHash(struct ImageHash *hash)
+{
+    static const uint64_t start[HASH_LANES] = {HASH_PRIME32_3, HASH_PRIME64_1, HASH_PRIME64_2, HASH_PRIME64_3,
+                                               HASH_PRIME64_4, HASH_PRIME32_2, HASH_PRIME64_5, HASH_PRIME32_1};
+    selectHashKernel();
+    memcpy(hash->lanes, start, sizeof(start));
+    hash->blocked = hash->total = 0;
+}
+
+// This function adds the next count pixels of the image to the hash.
+// Whole blocks are added straight from pixels, and only a block split between two calls is gathered.
+void addImageHash(struct ImageHash *hash, const unsigned char *pixels, long count)
+{
+    hash->total += count;
+    if (hash->blocked > 0)
+    {
+        long take = HASH_BLOCK_BYTES - hash->blocked < count ? HASH_BLOCK_BYTES - hash->blocked : count;
+        memcpy(hash->block + hash->blocked, pixels, take);
+        hash->blocked += take;
+        pixels += take;
+        count -= take;
+        if (hash->blocked < HASH_BLOCK_BYTES)
+            return;
+        hashKernel(hash->lanes, hash->block, HASH_BLOCK_STRIPES);
+        scrambleHashLanes(hash->lanes);
+        hash->blocked = 0;
+    }
+    for (; count >= HASH_BLOCK_BYTES; pixels += HASH_BLOCK_BYTES, count -= HASH_BLOCK_BYTES)
+    {
+        hashKernel(hash->lanes, pixels, HASH_BLOCK_STRIPES);
+        scrambleHashLanes(hash->lanes);
+    }
+    memcpy(hash->block, pixels, count);
+    hash->blocked = count;
+}
+
+// This function returns the hash of all the pixels added, together with the dimensions of the image.
+// The last part block is padded with zeros to whole stripes. The number of pixels and the dimensions
+// then go in with the lanes, so padding never makes two images alike.
+uint64_t finishImageHash(struct ImageHash *hash, int height, int width)
+{
+    long stripes = (hash->blocked + HASH_STRIPE_BYTES - 1) / HASH_STRIPE_BYTES;
+    memset(hash->block + hash->blocked, 0, stripes * HASH_STRIPE_BYTES - hash->blocked);
+    hashKernel(hash->lanes, hash->block, stripes);
+
+    uint64_t result = (uint64_t)hash->total * HASH_PRIME64_1 ^ ((uint64_t)height << 32 | (uint32_t)width) * HASH_PRIME64_2;
+    for (int lane = 0; lane < HASH_LANES; lane += 2)
+        result += foldHashProduct(hash->lanes[lane] ^ hashSecret[HASH_MERGE_WORD + lane], hash->lanes[lane + 1] ^ hashSecret[HASH_MERGE_WORD + lane + 1]);
+    result ^= result >> 37;
+    result *= HASH_PRIME64_3;
+    return result ^ (result >> 32);
+}
+
+// This function reads the sidecar of fileName into digest and returns 1 when it is there and was
+// written for the file as it is now, going by its size and the time it was last changed.
+static int loadHashSidecar(const char *fileName, const struct stat *status, struct ImageDigest *digest)
+{
+    char sidecarName[FILENAME_MAX];
+    if (snprintf(sidecarName, sizeof(sidecarName), "%s%s", fileName, HASH_SIDECAR_SUFFIX) >= (int)sizeof(sidecarName))
+        return 0;
+    FILE *sidecar = fopen(sidecarName, "r");
+    if (sidecar == NULL)
+        return 0;
+
+    unsigned long long hash;
+    unsigned int magicNumber;
+    long long size, seconds, nanoseconds;
+    int found = fscanf(sidecar, "ebh %llx %x %d %d %lld %lld %lld", &hash, &magicNumber, &digest->height, &digest->width,
+                       &size, &seconds, &nanoseconds) == 7;
+    fclose(sidecar);
+    if (!found || size != (long long)status->st_size || seconds != (long long)status->st_mtim.tv_sec ||
+        nanoseconds != (long long)status->st_mtim.tv_nsec)
+        return 0;
+    digest->hash = hash;
+    digest->magicNumber = (unsigned short)magicNumber;
+    return 1;
+}
+
+// This function writes the sidecar of fileName. It goes to a file of its own first and is then
+// renamed into place, so a sidecar is never seen half written. A sidecar which cannot be written
+// is simply left out, as it only saves time.
+static void saveHashSidecar(const char *fileName, const struct stat *status, const struct ImageDigest *digest)
+{
+    char sidecarName[FILENAME_MAX], partName[FILENAME_MAX];
+    if (snprintf(sidecarName, sizeof(sidecarName), "%s%s", fileName, HASH_SIDECAR_SUFFIX) >= (int)sizeof(sidecarName) ||
+        snprintf(partName, sizeof(partName), "%s.XXXXXX", sidecarName) >= (int)sizeof(partName))
+        return;
+    int partFile = mkstemp(partName);
+    if (partFile < 0)
+        return;
+    FILE *sidecar = fdopen(partFile, "w");
+    if (sidecar == NULL)
+    {
+        close(partFile);
+        unlink(partName);
+        return;
+    }
+    fprintf(sidecar, "ebh %016llx %04x %d %d %lld %lld %lld\n", (unsigned long long)digest->hash, digest->magicNumber,
+            digest->height, digest->width, (long long)status->st_size, (long long)status->st_mtim.tv_sec,
+            (long long)status->st_mtim.tv_nsec);
+    if (fclose(sidecar) != 0 || rename(partName, sidecarName) != 0)
+        unlink(partName);
+}
+
+// This function hashes an image file. A magic number of 0 takes the file in whatever format it is in.
+// When cache is set, a current sidecar is used instead of reading the file, and the hash of a file
+// which had to be read is saved in one. When against is given and the dimensions differ from it, the
+// pixels are not read and the hash is left as 0. Every error a comparison would find is found here.
+int digestImageFile(const char *fileName, unsigned short magicNumber, int cache, const struct ImageDigest *against, struct ImageDigest *digest)
+{
+    struct stat status;
+    if (stat(fileName, &status) != 0 || access(fileName, R_OK) != 0)
+        return BAD_FILE;
+    if (cache && loadHashSidecar(fileName, &status, digest))
+        return magicNumber != 0 && digest->magicNumber != magicNumber ? BAD_MAGIC_NUMBER : SUCCESS;
+
+    struct ImageReader reader;
+    initImageReader(&reader);
+    int check = openImageReader(&reader, fileName, magicNumber);
+    if (check != SUCCESS)
+    {
+        freeImageReader(&reader);
+        return check;
+    }
+    digest->magicNumber = reader.codec->magicNumber;
+    digest->height = reader.header.height;
+    digest->width = reader.header.width;
+    digest->hash = 0;
+    if (against != NULL && (against->height != digest->height || against->width != digest->width))
+    {
+        closeImageReader(&reader);
+        freeImageReader(&reader);
+        return SUCCESS;
+    }
+
+    unsigned char *chunk = (unsigned char *)malloc(STREAM_CHUNK_PIXELS);
+    if (chunk == NULL)
+        check = BAD_MALLOC;
+    struct ImageHash hash;
+    startImageHash(&hash);
+    while (reader.pixelsLeft > 0 && check == SUCCESS)
+    {
+        long count = reader.pixelsLeft < STREAM_CHUNK_PIXELS ? reader.pixelsLeft : STREAM_CHUNK_PIXELS;
+        check = readImagePixels(&reader, chunk, count);
+        if (check == SUCCESS)
+            addImageHash(&hash, chunk, count);
+    }
+    if (check == SUCCESS)
+        check = finishImageReader(&reader);
+    closeImageReader(&reader);
+    freeImageReader(&reader);
+    free(chunk);
+    if (check != SUCCESS)
+        return check;
+
+    digest->hash = finishImageHash(&hash, digest->height, digest->width);
+    if (cache)
+        saveHashSidecar(fileName, &status, digest);
+    return SUCCESS;
+}
+
+// This function prints the hash of an image file of any format as 16 hex digits, or the usual error.
+int printImageHash(const char *fileName, int cache)
+{
+    struct ImageDigest digest;
+    int check = digestImageFile(fileName, 0, cache, NULL, &digest);
+    if (check != SUCCESS)
+    {
+        reportImageError(check, fileName);
+        return check;
+    }
+    printf("%016llx\n", (unsigned long long)digest.hash);
+    return SUCCESS;
+}
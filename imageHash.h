@@ -0,0 +1,70 @@
+#ifndef IMAGE_HASH_H
+#define IMAGE_HASH_H
+
+#include <stdint.h>
+#include "image.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HASH_X86_KERNELS 1
+#endif
+
+// The content hash is built like xxHash's XXH3. Eight 64 bit lanes take the pixels 64 bytes, a stripe,
+// at a time, each stripe of a block mixed with its own part of a fixed secret, and the lanes are
+// scrambled after every block so that the order of blocks counts as well as the order within one.
+// Only the dimensions and the pixel values go in, so the same image hashes the same in every format.
+#define HASH_LANES 8
+#define HASH_STRIPE_BYTES 64
+#define HASH_BLOCK_STRIPES 16
+#define HASH_BLOCK_BYTES (HASH_STRIPE_BYTES * HASH_BLOCK_STRIPES)
+
+// A sidecar holding the hash of fileName is named fileName followed by this.
+#define HASH_SIDECAR_SUFFIX ".ebh"
+
+// This function adds count stripes, starting at the first stripe of a block, to the lanes.
+typedef void (*ImageHashKernel)(uint64_t *lanes, const unsigned char *stripes, long count);
+
+// This function adds stripes without a vector unit.
+void accumulateHashScalar(uint64_t *lanes, const unsigned char *stripes, long count);
+
+#ifdef HASH_X86_KERNELS
+// These functions do the same with SSE2 and AVX2. The AVX2 kernel must only run where the processor has it.
+void accumulateHashSse2(uint64_t *lanes, const unsigned char *stripes, long count);
+void accumulateHashAvx2(uint64_t *lanes, const unsigned char *stripes, long count);
+#endif
+
+// This function picks the kernel image hashes use, honouring HASH_KERNEL.
+void selectHashKernel(void);
+
+// A hash being taken of a stream of pixels, which may be added in pieces of any size.
+typedef struct ImageHash
+{
+    uint64_t lanes[HASH_LANES];
+    // The start of a block not yet added, and the number of pixels added in all.
+    unsigned char block[HASH_BLOCK_BYTES];
+    long blocked, total;
+} ImageHash;
+
+// What is known about one image file from its hash.
+typedef struct ImageDigest
+{
+    uint64_t hash;
+    unsigned short magicNumber;
+    int height, width;
+} ImageDigest;
+
+// This function starts the hash of a new image.
+void startImageHash(struct ImageHash *hash);
+
+// This function adds the next count pixels of the image to the hash.
+void addImageHash(struct ImageHash *hash, const unsigned char *pixels, long count);
+
+// This function returns the hash of all the pixels added, together with the dimensions of the image.
+uint64_t finishImageHash(struct ImageHash *hash, int height, int width);
+
+// This function hashes an image file, from its sidecar when cache is set and the sidecar is current.
+int digestImageFile(const char *fileName, unsigned short magicNumber, int cache, const struct ImageDigest *against, struct ImageDigest *digest);
+
+// This function prints the hash of an image file of any format, or the usual error.
+int printImageHash(const char *fileName, int cache);
+
+#endif
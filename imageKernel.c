@@ -0,0 +1,22 @@
+#include <stdlib.h>
+#include <string.h>
+#include "imageKernel.h"
+
+// This function returns the fastest kernel level the processor supports. Setting the environment variable
+// named by variable to scalar or sse2 caps the level there, and anything else leaves it to the processor.
+// Without x86 there are only scalar kernels.
+int pickImageKernel(const char *variable)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    const char *forced = getenv(variable);
+    if (forced != NULL && strcmp(forced, "scalar") == 0)
+        return IMAGE_KERNEL_SCALAR;
+    if (forced != NULL && strcmp(forced, "sse2") == 0)
+        return IMAGE_KERNEL_SSE2;
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? IMAGE_KERNEL_AVX2 : IMAGE_KERNEL_SSE2;
+#else
+    (void)variable;
+    return IMAGE_KERNEL_SCALAR;
+#endif
+}
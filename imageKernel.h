@@ -0,0 +1,13 @@
+#ifndef IMAGE_KERNEL_H
+#define IMAGE_KERNEL_H
+
+// The kernels each vector module has, from slowest to fastest. A module keeps one of each in a table
+// and runs the one at the level pickImageKernel returns.
+#define IMAGE_KERNEL_SCALAR 0
+#define IMAGE_KERNEL_SSE2 1
+#define IMAGE_KERNEL_AVX2 2
+
+// This function returns the fastest kernel level the processor supports, or the one the named variable forces.
+int pickImageKernel(const char *variable);
+
+#endif
@@ -0,0 +1,377 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "imageStream.h"
+#include "ebuMap.h"
+#include "ebfParallel.h"
+#include "ebcPack.h"
+
+// This function sets up a reader with no blocks, ready for its first file.
+void initImageReader(struct ImageReader *reader)
+{
+    reader->inputFile = NULL;
+    reader->codec = NULL;
+    reader->parseBlock = reader->packed = reader->unpacked = NULL;
+    reader->band = reader->bandPacked = NULL;
+    reader->bandCapacity = reader->bandPackedCapacity = 0;
+}
+
+// This function closes the file of an open reader, keeping its blocks for the next file.
+void closeImageReader(struct ImageReader *reader)
+{
+    fclose(reader->inputFile);
+    reader->inputFile = NULL;
+}
+
+// This function reads the header of a reader's newly opened stream and starts its codec.
+// The stream is closed again when anything is wrong.
+static int startImageReader(struct ImageReader *reader, unsigned short magicNumber)
+{
+    int check = readImageHeader(reader->inputFile, &reader->header, magicNumber);
+    if (check == SUCCESS)
+    {
+        reader->pixelsLeft = reader->packedPixelsLeft = reader->header.numBytes;
+        check = reader->codec->startReader(reader);
+    }
+
+    if (check != SUCCESS)
+    { // check stream state
+        closeImageReader(reader);
+        return check;
+    } // check stream state
+    return SUCCESS;
+}
+
+// This function opens fileName, checks it has the given magic number and reads its header.
+// A magic number of 0 takes the file in whatever format its own magic number names.
+// Any block the format needs is allocated the first time it is needed.
+// Nothing is printed, so a caller can decide when to report the error with reportImageError.
+int openImageReader(struct ImageReader *reader, const char *fileName, unsigned short magicNumber)
+{
+    reader->unpackedPosition = reader->unpackedCount = 0;
+    initImageFileInfo(&reader->header);
+    if (magicNumber == 0)
+    {
+        int check = SUCCESS;
+        const struct ImageCodec *codec = detectImageCodec(fileName, &check);
+        if (codec == NULL)
+            return check;
+        magicNumber = codec->magicNumber;
+    }
+    reader->codec = findImageCodec(magicNumber);
+    if (reader->codec == NULL)
+        return BAD_MAGIC_NUMBER;
+
+    // open the input file in read mode
+    reader->inputFile = fopen(fileName, "rb");
+    if (!reader->inputFile)
+        return BAD_FILE;
+    return startImageReader(reader, magicNumber);
+}
+
+// This function opens an image held in size bytes of memory like openImageReader, and a magic number
+// of 0 takes it in whatever format it is in. The codecs read it through a stream over the bytes, which
+// must stay in place until the reader is closed, so nothing is copied and the file system is not touched.
+int openImageReaderMemory(struct ImageReader *reader, const unsigned char *bytes, size_t size, unsigned short magicNumber)
+{
+    reader->unpackedPosition = reader->unpackedCount = 0;
+    initImageFileInfo(&reader->header);
+    // an image is never shorter than its magic number, and a stream over nothing cannot be opened
+    if (size < 2)
+        return BAD_MAGIC_NUMBER;
+    if (magicNumber == 0)
+        magicNumber = (unsigned short)(bytes[0] | bytes[1] << 8);
+    reader->codec = findImageCodec(magicNumber);
+    if (reader->codec == NULL)
+        return BAD_MAGIC_NUMBER;
+
+    reader->inputFile = fmemopen((void *)bytes, size, "rb");
+    if (!reader->inputFile)
+        return BAD_MALLOC;
+    return startImageReader(reader, magicNumber);
+}
+
+// This function reads the next count pixels of the image into pixels and checks they are in range.
+// It returns BAD_DATA when the file runs out or holds a bad value.
+int readImagePixels(struct ImageReader *reader, unsigned char *pixels, long count)
+{
+    if (count > reader->pixelsLeft || reader->codec->readPixels(reader, pixels, count) != SUCCESS)
+        return BAD_DATA;
+    reader->pixelsLeft -= count;
+    return SUCCESS;
+}
+
+// This function checks that nothing but the allowed padding follows the last pixel.
+// It returns BAD_DATA when the file holds too much data.
+int finishImageReader(struct ImageReader *reader)
+{
+    return reader->codec->finishReader(reader);
+}
+
+// This function frees the blocks of a reader once it is finished with.
+void freeImageReader(struct ImageReader *reader)
+{
+    free(reader->parseBlock);
+    free(reader->packed);
+    free(reader->unpacked);
+    free(reader->band);
+    free(reader->bandPacked);
+    reader->parseBlock = reader->packed = reader->unpacked = NULL;
+    reader->band = reader->bandPacked = NULL;
+    reader->bandCapacity = reader->bandPackedCapacity = 0;
+}
+
+// This function writes size bytes to the file, carrying on after a partial write.
+// It returns BAD_OUTPUT when the file will not take them all.
+int writeAllBytes(int outputFile, const unsigned char *bytes, size_t size)
+{
+    while (size > 0)
+    {
+        ssize_t written = write(outputFile, bytes, size);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return BAD_OUTPUT;
+        bytes += written;
+        size -= (size_t)written;
+    }
+    return SUCCESS;
+}
+
+// This function copies size bytes to the end of a writer's memory.
+// A block of the writer's own is at least doubled whenever it is too small, so it is copied only a few
+// times however the output is written. It returns BAD_OUTPUT when the caller's block is full.
+static int appendImageMemory(struct ImageWriter *writer, const unsigned char *bytes, size_t size)
+{
+    if (writer->memoryCapacity - writer->memoryUsed < size)
+    {
+        if (!writer->memoryOwned)
+            return BAD_OUTPUT;
+        size_t capacity = writer->memoryCapacity * 2 > writer->memoryUsed + size ? writer->memoryCapacity * 2 : writer->memoryUsed + size;
+        unsigned char *larger = (unsigned char *)realloc(writer->memory, capacity);
+        if (larger == NULL)
+            return BAD_OUTPUT;
+        writer->memory = larger;
+        writer->memoryCapacity = capacity;
+    }
+    memcpy(writer->memory + writer->memoryUsed, bytes, size);
+    writer->memoryUsed += size;
+    return SUCCESS;
+}
+
+// This function writes size bytes to the writer's file or memory, past its buffer.
+// It returns BAD_OUTPUT when they cannot all be written.
+int writeImageBytes(struct ImageWriter *writer, const unsigned char *bytes, size_t size)
+{
+    if (writer->outputFile == IMAGE_WRITER_MEMORY)
+        return appendImageMemory(writer, bytes, size);
+    return writeAllBytes(writer->outputFile, bytes, size);
+}
+
+// This function writes out everything in the buffer.
+int flushImageWriter(struct ImageWriter *writer)
+{
+    int check = writeImageBytes(writer, writer->buffer, writer->buffered);
+    writer->buffered = 0;
+    return check;
+}
+
+// This function sets up a writer with no blocks, ready for its first file.
+void initImageWriter(struct ImageWriter *writer)
+{
+    writer->outputFile = -1;
+    writer->codec = NULL;
+    writer->buffer = writer->pending = writer->band = NULL;
+    writer->bandCapacity = 0;
+    writer->memory = NULL;
+    writer->memoryUsed = writer->memoryCapacity = 0;
+    writer->memoryOwned = 0;
+}
+
+// This function makes the next image the writer opens with no file name go into memory.
+// With a block of the caller's the image must fit in capacity bytes. With memory NULL it goes into a
+// block of the writer's own, which is kept from one image to the next like its other blocks.
+// Either way the image is at writer->memory, writer->memoryUsed bytes long, once the writer is closed.
+void setImageWriterMemory(struct ImageWriter *writer, unsigned char *memory, size_t capacity)
+{
+    if (memory == NULL && writer->memoryOwned)
+        return;
+    if (writer->memoryOwned)
+        free(writer->memory);
+    writer->memory = memory;
+    writer->memoryCapacity = memory == NULL ? 0 : capacity;
+    writer->memoryOwned = memory == NULL;
+}
+
+// This function creates fileName and writes the header for an image of the given format and size.
+// With no file name the image goes into the memory set by setImageWriterMemory instead.
+// It returns BAD_FILE when the file cannot be opened, or BAD_MALLOC.
+int openImageWriter(struct ImageWriter *writer, const char *fileName, unsigned short magicNumber, int height, int width)
+{
+    writer->codec = findImageCodec(magicNumber);
+    writer->width = width;
+    writer->pixelsWritten = 0;
+    writer->pendingCount = 0;
+    writer->buffered = 0;
+    if (writer->codec == NULL)
+        return BAD_MAGIC_NUMBER;
+    if (countImageBytes(height, width, &writer->numBytes) != SUCCESS)
+        return BAD_MALLOC;
+
+    // allocate any missing block before creating the file, so a failure leaves nothing behind
+    if (writer->buffer == NULL)
+    {
+        writer->bufferSize = IMAGE_WRITE_BUFFER;
+        if (writer->bufferSize < (size_t)ebcPackedSize(ebcBlockPixels()))
+            writer->bufferSize = (size_t)ebcPackedSize(ebcBlockPixels());
+        writer->buffer = (unsigned char *)malloc(writer->bufferSize);
+    }
+    if (writer->buffer == NULL || writer->codec->startWriter(writer) != SUCCESS)
+        return BAD_MALLOC;
+
+    // open the output file in write mode, or start again at the beginning of the memory
+    writer->memoryUsed = 0;
+    writer->outputFile = fileName == NULL ? IMAGE_WRITER_MEMORY : open(fileName, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (writer->outputFile == -1)
+        return BAD_FILE;
+
+    // the header goes into the buffer first, the magic number is stored low byte first
+    writer->buffered = (size_t)sprintf((char *)writer->buffer, "%c%c\n%d %d\n", magicNumber & 0xFF, magicNumber >> 8, height, width);
+    return SUCCESS;
+}
+
+// This function writes the next count pixels of the image.
+// It returns BAD_OUTPUT when the file cannot be written.
+int writeImagePixels(struct ImageWriter *writer, const unsigned char *pixels, long count)
+{
+    return writer->codec->writePixels(writer, pixels, count);
+}
+
+// This function writes anything still held by the writer and closes the file, keeping its blocks.
+// It returns BAD_OUTPUT when the last of the data cannot be written.
+int closeImageWriter(struct ImageWriter *writer)
+{
+    int check = writer->codec->finishWriter(writer);
+    if (check == SUCCESS)
+        check = flushImageWriter(writer);
+
+    if (writer->outputFile != IMAGE_WRITER_MEMORY && close(writer->outputFile) != 0)
+        check = BAD_OUTPUT;
+    writer->outputFile = -1;
+    return check;
+}
+
+// This function frees the blocks of a writer once it is finished with.
+void freeImageWriter(struct ImageWriter *writer)
+{
+    free(writer->buffer);
+    free(writer->pending);
+    free(writer->band);
+    if (writer->memoryOwned)
+        free(writer->memory);
+    writer->buffer = writer->pending = writer->band = writer->memory = NULL;
+    writer->bandCapacity = writer->memoryUsed = writer->memoryCapacity = 0;
+    writer->memoryOwned = 0;
+}
+
+// This function reads every pixel of the image an open reader is at into one block and closes the reader.
+static int loadImageReader(struct ImageFileInfo *imageFileInfo, struct ImageReader *reader)
+{
+    imageFileInfo->magicNumber[0] = reader->header.magicNumber[0];
+    imageFileInfo->magicNumber[1] = reader->header.magicNumber[1];
+    imageFileInfo->height = reader->header.height;
+    imageFileInfo->width = reader->header.width;
+    int check = allocateImageData(imageFileInfo);
+    if (check == SUCCESS)
+        check = readImagePixels(reader, imageFileInfo->imageData, imageFileInfo->numBytes);
+    if (check == SUCCESS)
+        check = finishImageReader(reader);
+    if (check != SUCCESS)
+        clearImageData(imageFileInfo);
+    closeImageReader(reader);
+    return check;
+}
+
+// This function reads a whole image file of the given format into one block.
+// ebu files are mapped rather than read, see readEbuImage, and large ebf files are parsed on several
+// threads, see readEbfImage. Everything else goes through a reader,
+// which is asked for every pixel at once.
+// It returns SUCCESS or the error code, without printing anything. The image is released with clearImageData.
+int loadImageFile(struct ImageFileInfo *imageFileInfo, const char *fileName, unsigned short magicNumber)
+{
+    if (magicNumber == MAGIC_NUMBER_EBU)
+        return readEbuImage(imageFileInfo, fileName);
+    if (magicNumber == MAGIC_NUMBER_EBF)
+        return readEbfImage(imageFileInfo, fileName);
+
+    struct ImageReader reader;
+    initImageReader(&reader);
+    int check = openImageReader(&reader, fileName, magicNumber);
+    if (check == SUCCESS)
+        check = loadImageReader(imageFileInfo, &reader);
+    freeImageReader(&reader);
+    return check;
+}
+
+// This function reads a whole image of the given format, or any when it is 0, from size bytes of memory
+// into one block, the way loadImageFile reads a file. Nothing is printed.
+int loadImageMemory(struct ImageFileInfo *imageFileInfo, const unsigned char *bytes, size_t size, unsigned short magicNumber)
+{
+    struct ImageReader reader;
+    initImageReader(&reader);
+    int check = openImageReaderMemory(&reader, bytes, size, magicNumber);
+    if (check == SUCCESS)
+        check = loadImageReader(imageFileInfo, &reader);
+    freeImageReader(&reader);
+    return check;
+}
+
+// This function writes every row of an image with a writer opened for it, and closes the writer.
+static int writeImageRows(const struct ImageFileInfo *imageFileInfo, struct ImageWriter *writer)
+{
+    int check = SUCCESS;
+    for (long row = 0; row < imageFileInfo->height && check == SUCCESS; row++)
+        check = writeImagePixels(writer, imageRow(imageFileInfo, row), imageFileInfo->width);
+    int closed = closeImageWriter(writer);
+    return check == SUCCESS ? closed : check;
+}
+
+// This function writes a whole image held in memory to fileName in the given format.
+// It returns SUCCESS or the error code of the writer, without printing anything.
+int writeImageFile(const struct ImageFileInfo *imageFileInfo, const char *fileName, unsigned short magicNumber)
+{
+    struct ImageWriter writer;
+    initImageWriter(&writer);
+    int check = openImageWriter(&writer, fileName, magicNumber, imageFileInfo->height, imageFileInfo->width);
+    if (check == SUCCESS)
+        check = writeImageRows(imageFileInfo, &writer);
+    freeImageWriter(&writer);
+    return check;
+}
+
+// This function encodes a whole image in the given format into memory, without touching the file system.
+// When *output is a block of the caller's the image must fit in its *size bytes, and when it is NULL
+// a block is malloced for it, which the caller frees. Either way *size is set to the length of the image.
+// It returns SUCCESS or the error code of the writer, BAD_OUTPUT when the caller's block is too small.
+int writeImageMemory(const struct ImageFileInfo *imageFileInfo, unsigned short magicNumber, unsigned char **output, size_t *size)
+{
+    struct ImageWriter writer;
+    initImageWriter(&writer);
+    setImageWriterMemory(&writer, *output, *size);
+    int check = openImageWriter(&writer, NULL, magicNumber, imageFileInfo->height, imageFileInfo->width);
+    if (check == SUCCESS)
+        check = writeImageRows(imageFileInfo, &writer);
+    if (check == SUCCESS)
+    {
+        // the block is handed over rather than freed with the writer
+        *output = writer.memory;
+        *size = writer.memoryUsed;
+        writer.memory = NULL;
+        writer.memoryOwned = 0;
+    }
+    freeImageWriter(&writer);
+    return check;
+}
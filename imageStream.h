@@ -0,0 +1,145 @@
+#ifndef IMAGE_STREAM_H
+#define IMAGE_STREAM_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "image.h"
+#include "imageCodec.h"
+#include "ebfParse.h"
+
+// Number of pixels a streaming tool holds in one chunk or strip, so its memory does not grow with the image.
+#define STREAM_CHUNK_PIXELS (1L << 20)
+
+// Least size of the buffer a writer formats output into before handing it to the operating system.
+// The buffer is made larger when it must hold a whole packed ebc block, see ebcBlockPixels.
+#define IMAGE_WRITE_BUFFER (1 << 20)
+
+// A reader walks through the pixels of one image file in order without ever holding the whole image.
+// Its blocks are kept from one file to the next, so a reader can be reopened without allocating again.
+typedef struct ImageReader
+{
+    FILE *inputFile;
+    const struct ImageCodec *codec;
+
+    // Magic number and dimensions from the header. header.imageData is never allocated.
+    struct ImageFileInfo header;
+    // Number of pixels still to be read.
+    long pixelsLeft;
+
+    // ebf text is scanned by a block parser.
+    struct EbfParser ebfParser;
+    unsigned char *parseBlock;
+    // ebc data is unpacked a block at a time, and the pixels not yet handed out are kept here.
+    unsigned char *packed, *unpacked;
+    long unpackedPosition, unpackedCount;
+    // Number of pixels whose packed data is still in the file.
+    long packedPixelsLeft;
+    // Tiled ebc is unpacked a band of tiles at a time, one tile high and the image wide,
+    // and the band is handed out like the unpacked block above.
+    int tileSize;
+    long tileRow;
+    unsigned char *band, *bandPacked;
+    size_t bandCapacity, bandPackedCapacity;
+} ImageReader;
+
+// The output file of a writer which writes into memory rather than a file.
+#define IMAGE_WRITER_MEMORY (-2)
+
+// A writer produces an image file from pixels handed to it in order, a strip at a time.
+// Everything is formatted into one large buffer which is written out in big blocks.
+// Like a reader, it keeps its blocks from one file to the next.
+typedef struct ImageWriter
+{
+    int outputFile;
+    // Output written into memory goes into the caller's block of memoryCapacity bytes, or into a block
+    // of the writer's own when memoryOwned is set, which grows as needed and is kept like the others.
+    unsigned char *memory;
+    size_t memoryUsed, memoryCapacity;
+    int memoryOwned;
+    const struct ImageCodec *codec;
+    int width;
+    // Number of pixels written so far and in the whole image, which places the ebf separators.
+    long pixelsWritten, numBytes;
+
+    // Output waiting to be written, and the size of the buffer.
+    unsigned char *buffer;
+    size_t buffered, bufferSize;
+
+    // ebc pixels are gathered here until a whole block can be packed.
+    unsigned char *pending;
+    long pendingCount;
+    // Tiled ebc pixels are gathered a band of tiles at a time, and the band number places the index.
+    unsigned char *band;
+    size_t bandCapacity;
+    long bandCount, tileRow;
+} ImageWriter;
+
+// This function sets up a reader with no blocks, ready for its first file.
+void initImageReader(struct ImageReader *reader);
+
+// This function opens fileName, checks it has the given magic number, or any when it is 0, and reads its header.
+int openImageReader(struct ImageReader *reader, const char *fileName, unsigned short magicNumber);
+
+// This function opens an image held in size bytes of memory like openImageReader, without touching the file system.
+int openImageReaderMemory(struct ImageReader *reader, const unsigned char *bytes, size_t size, unsigned short magicNumber);
+
+// This function reads the next count pixels of the image into pixels and checks they are in range.
+int readImagePixels(struct ImageReader *reader, unsigned char *pixels, long count);
+
+// This function checks that nothing but the allowed padding follows the last pixel.
+int finishImageReader(struct ImageReader *reader);
+
+// This function closes the file of an open reader, keeping its blocks for the next file.
+void closeImageReader(struct ImageReader *reader);
+
+// This function frees the blocks of a reader once it is finished with.
+void freeImageReader(struct ImageReader *reader);
+
+// This function sets up a writer with no blocks, ready for its first file.
+void initImageWriter(struct ImageWriter *writer);
+
+// This function makes the writer write into memory, the caller's block or one of its own when memory is NULL.
+void setImageWriterMemory(struct ImageWriter *writer, unsigned char *memory, size_t capacity);
+
+// This function creates fileName, or starts writing into memory when it is NULL, and writes the header.
+int openImageWriter(struct ImageWriter *writer, const char *fileName, unsigned short magicNumber, int height, int width);
+
+// This function writes the next count pixels of the image.
+int writeImagePixels(struct ImageWriter *writer, const unsigned char *pixels, long count);
+
+// This function writes anything still held by the writer and closes the file, keeping its blocks.
+int closeImageWriter(struct ImageWriter *writer);
+
+// This function frees the blocks of a writer once it is finished with.
+void freeImageWriter(struct ImageWriter *writer);
+
+// This function writes size bytes to the file, carrying on after a partial write.
+int writeAllBytes(int outputFile, const unsigned char *bytes, size_t size);
+
+// This function writes size bytes to the writer's file or memory, past its buffer.
+int writeImageBytes(struct ImageWriter *writer, const unsigned char *bytes, size_t size);
+
+// This function writes out everything in the writer's buffer.
+int flushImageWriter(struct ImageWriter *writer);
+
+// This function makes sure at least size bytes are free at the end of the buffer.
+static inline int reserveImageWriter(struct ImageWriter *writer, size_t size)
+{
+    if (writer->bufferSize - writer->buffered >= size)
+        return SUCCESS;
+    return flushImageWriter(writer);
+}
+
+// This function reads a whole image file of the given format into memory.
+int loadImageFile(struct ImageFileInfo *imageFileInfo, const char *fileName, unsigned short magicNumber);
+
+// This function writes a whole image held in memory to fileName in the given format.
+int writeImageFile(const struct ImageFileInfo *imageFileInfo, const char *fileName, unsigned short magicNumber);
+
+// This function reads a whole image of the given format, or any when it is 0, from size bytes of memory.
+int loadImageMemory(struct ImageFileInfo *imageFileInfo, const unsigned char *bytes, size_t size, unsigned short magicNumber);
+
+// This function encodes a whole image into the caller's block of *size bytes, or a malloced one when *output is NULL.
+int writeImageMemory(const struct ImageFileInfo *imageFileInfo, unsigned short magicNumber, unsigned char **output, size_t *size);
+
+#endif
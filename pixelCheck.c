@@ -0,0 +1,91 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "pixelCheck.h"
+#include "imageKernel.h"
+
+#ifdef PIXEL_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+// This function returns the offset of the first pixel above 31, or count when every pixel is in range.
+// Eight pixels are ORed at a time as one 64-bit word, so it needs no vector unit.
+long findBadPixelScalar(const unsigned char *pixels, long count)
+{
+    const uint64_t highBits = 0x0101010101010101ULL * PIXEL_HIGH_BITS;
+    long start = 0;
+    for (; start + 32 <= count; start += 32)
+    {
+        uint64_t words[4];
+        memcpy(words, pixels + start, sizeof(words));
+        if (((words[0] | words[1] | words[2] | words[3]) & highBits) != 0)
+            break;
+    }
+    // The tail, and the chunk which failed, are searched one pixel at a time.
+    for (; start < count; start++)
+    {
+        if (pixels[start] & PIXEL_HIGH_BITS)
+            return start;
+    }
+    return count;
+}
+
+#ifdef PIXEL_X86_KERNELS
+// This function checks 64 pixels at a time with SSE2.
+long findBadPixelSse2(const unsigned char *pixels, long count)
+{
+    const __m128i highBits = _mm_set1_epi8((char)PIXEL_HIGH_BITS);
+    long start = 0;
+    for (; start + 64 <= count; start += 64)
+    {
+        __m128i bits = _mm_or_si128(_mm_or_si128(_mm_loadu_si128((const __m128i *)(pixels + start)), _mm_loadu_si128((const __m128i *)(pixels + start + 16))),
+                                    _mm_or_si128(_mm_loadu_si128((const __m128i *)(pixels + start + 32)), _mm_loadu_si128((const __m128i *)(pixels + start + 48))));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(bits, highBits), _mm_setzero_si128())) != 0xFFFF)
+            break;
+    }
+    return start + findBadPixelScalar(pixels + start, count - start);
+}
+
+// This function checks 128 pixels at a time with AVX2.
+__attribute__((target("avx2"))) long findBadPixelAvx2(const unsigned char *pixels, long count)
+{
+    const __m256i highBits = _mm256_set1_epi8((char)PIXEL_HIGH_BITS);
+    long start = 0;
+    for (; start + 128 <= count; start += 128)
+    {
+        __m256i bits = _mm256_or_si256(_mm256_or_si256(_mm256_loadu_si256((const __m256i *)(pixels + start)), _mm256_loadu_si256((const __m256i *)(pixels + start + 32))),
+                                       _mm256_or_si256(_mm256_loadu_si256((const __m256i *)(pixels + start + 64)), _mm256_loadu_si256((const __m256i *)(pixels + start + 96))));
+        if (!_mm256_testz_si256(bits, highBits))
+            break;
+    }
+    return start + findBadPixelSse2(pixels + start, count - start);
+}
+#endif
+
+static PixelCheckKernel pixelCheckKernel = NULL;
+static pthread_once_t pixelCheckOnce = PTHREAD_ONCE_INIT;
+
+// This function picks the fastest kernel the processor supports, or the one PIXEL_KERNEL forces.
+static void pickPixelCheckKernel(void)
+{
+    pixelCheckKernel = findBadPixelScalar;
+#ifdef PIXEL_X86_KERNELS
+    const PixelCheckKernel kernels[] = {findBadPixelScalar, findBadPixelSse2, findBadPixelAvx2};
+    pixelCheckKernel = kernels[pickImageKernel("PIXEL_KERNEL")];
+#endif
+}
+
+// This function picks the kernel the first time any thread calls it.
+void selectPixelCheckKernel(void)
+{
+    pthread_once(&pixelCheckOnce, pickPixelCheckKernel);
+}
+
+// This function returns the offset of the first pixel above 31, or count when every pixel is in range.
+// The whole buffer is checked in one pass, away from the loop which read it.
+long findBadPixel(const unsigned char *pixels, long count)
+{
+    selectPixelCheckKernel();
+    return pixelCheckKernel(pixels, count);
+}
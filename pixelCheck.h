@@ -0,0 +1,30 @@
+#ifndef PIXEL_CHECK_H
+#define PIXEL_CHECK_H
+
+#include "image.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PIXEL_X86_KERNELS 1
+#endif
+
+// A grey value is in range exactly when none of these bits are set.
+#define PIXEL_HIGH_BITS 0xE0
+
+typedef long (*PixelCheckKernel)(const unsigned char *pixels, long count);
+
+// This function is the range check without a vector unit.
+long findBadPixelScalar(const unsigned char *pixels, long count);
+
+#ifdef PIXEL_X86_KERNELS
+// These functions do the same check with SSE2 and AVX2. The AVX2 kernel must only run where the processor has it.
+long findBadPixelSse2(const unsigned char *pixels, long count);
+long findBadPixelAvx2(const unsigned char *pixels, long count);
+#endif
+
+// This function picks the kernel findBadPixel uses, honouring PIXEL_KERNEL.
+void selectPixelCheckKernel(void);
+
+// This function returns the offset of the first pixel above 31, or count when every pixel is in range.
+long findBadPixel(const unsigned char *pixels, long count);
+
+#endif
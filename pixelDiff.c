@@ -0,0 +1,207 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "pixelDiff.h"
+#include "imageKernel.h"
+
+#ifdef PIXEL_X86_DIFF_KERNELS
+#include <immintrin.h>
+#endif
+
+// The most blocks which differ a vector kernel adds to its 32 bit sums of squares before moving them
+// to 64 bits. Each lane takes at most four squares of 255 a block, so they cannot overflow before this.
+#define DIFF_SQUARE_BLOCKS 4096
+
+// This function starts a diff of runs which do not differ.
+static void startPixelDiff(struct PixelDiff *diff)
+{
+    diff->mismatches = 0;
+    diff->firstOffset = diff->lastOffset = -1;
+    diff->squares = 0;
+    diff->maxDelta = 0;
+}
+
+// This function adds the diff of a later run, which starts offset pixels in, to diff.
+static void addPixelDiff(struct PixelDiff *diff, const struct PixelDiff *part, long offset)
+{
+    if (part->mismatches == 0)
+        return;
+    if (diff->firstOffset < 0)
+        diff->firstOffset = offset + part->firstOffset;
+    diff->lastOffset = offset + part->lastOffset;
+    diff->mismatches += part->mismatches;
+    diff->squares += part->squares;
+    if (part->maxDelta > diff->maxDelta)
+        diff->maxDelta = part->maxDelta;
+}
+
+// This function compares count pixels one at a time, skipping eight at a time while they match as one 64-bit word.
+void diffPixelsScalar(const unsigned char *first, const unsigned char *second, long count, struct PixelDiff *diff)
+{
+    startPixelDiff(diff);
+    long start = 0;
+    while (start < count)
+    {
+        if (start + 8 <= count)
+        {
+            uint64_t firstWord, secondWord;
+            memcpy(&firstWord, first + start, sizeof(firstWord));
+            memcpy(&secondWord, second + start, sizeof(secondWord));
+            if (firstWord == secondWord)
+            {
+                start += 8;
+                continue;
+            }
+        }
+        for (long end = start + 8 < count ? start + 8 : count; start < end; start++)
+        {
+            int delta = abs(first[start] - second[start]);
+            if (delta == 0)
+                continue;
+            if (diff->firstOffset < 0)
+                diff->firstOffset = start;
+            diff->lastOffset = start;
+            diff->mismatches++;
+            diff->squares += (unsigned long long)(delta * delta);
+            if (delta > diff->maxDelta)
+                diff->maxDelta = delta;
+        }
+    }
+}
+
+#ifdef PIXEL_X86_DIFF_KERNELS
+// This function moves the 32 bit sums of squares of a vector kernel into diff.
+static void addDiffSquares(struct PixelDiff *diff, const uint32_t *sums, int lanes)
+{
+    for (int lane = 0; lane < lanes; lane++)
+        diff->squares += sums[lane];
+}
+
+// This function adds the largest of the absolute differences a vector kernel kept to diff.
+static void addDiffLargest(struct PixelDiff *diff, const unsigned char *largest, int lanes)
+{
+    for (int lane = 0; lane < lanes; lane++)
+    {
+        if (largest[lane] > diff->maxDelta)
+            diff->maxDelta = largest[lane];
+    }
+}
+
+// This function compares 16 pixels at a time with SSE2. Only a block which differs goes further than one
+// comparison, and its absolute differences are counted, squared and kept the largest of in vectors.
+void diffPixelsSse2(const unsigned char *first, const unsigned char *second, long count, struct PixelDiff *diff)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i largest = zero, squares = zero;
+    uint32_t sums[4];
+    unsigned char bytes[16];
+    int blocks = 0;
+    startPixelDiff(diff);
+
+    long start = 0;
+    for (; start + 16 <= count; start += 16)
+    {
+        __m128i firstBlock = _mm_loadu_si128((const __m128i *)(first + start));
+        __m128i secondBlock = _mm_loadu_si128((const __m128i *)(second + start));
+        unsigned int mask = ~(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(firstBlock, secondBlock)) & 0xFFFF;
+        if (mask == 0)
+            continue;
+
+        if (diff->firstOffset < 0)
+            diff->firstOffset = start + __builtin_ctz(mask);
+        diff->lastOffset = start + 31 - __builtin_clz(mask);
+        diff->mismatches += __builtin_popcount(mask);
+        __m128i delta = _mm_or_si128(_mm_subs_epu8(firstBlock, secondBlock), _mm_subs_epu8(secondBlock, firstBlock));
+        __m128i low = _mm_unpacklo_epi8(delta, zero), high = _mm_unpackhi_epi8(delta, zero);
+        largest = _mm_max_epu8(largest, delta);
+        squares = _mm_add_epi32(squares, _mm_add_epi32(_mm_madd_epi16(low, low), _mm_madd_epi16(high, high)));
+        if (++blocks == DIFF_SQUARE_BLOCKS)
+        {
+            _mm_storeu_si128((__m128i *)sums, squares);
+            addDiffSquares(diff, sums, 4);
+            squares = zero;
+            blocks = 0;
+        }
+    }
+    _mm_storeu_si128((__m128i *)sums, squares);
+    addDiffSquares(diff, sums, 4);
+    _mm_storeu_si128((__m128i *)bytes, largest);
+    addDiffLargest(diff, bytes, 16);
+
+    struct PixelDiff tail;
+    diffPixelsScalar(first + start, second + start, count - start, &tail);
+    addPixelDiff(diff, &tail, start);
+}
+
+// This function compares 32 pixels at a time with AVX2, in the same way as the SSE2 kernel.
+__attribute__((target("avx2"))) void diffPixelsAvx2(const unsigned char *first, const unsigned char *second, long count, struct PixelDiff *diff)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i largest = zero, squares = zero;
+    uint32_t sums[8];
+    unsigned char bytes[32];
+    int blocks = 0;
+    startPixelDiff(diff);
+
+    long start = 0;
+    for (; start + 32 <= count; start += 32)
+    {
+        __m256i firstBlock = _mm256_loadu_si256((const __m256i *)(first + start));
+        __m256i secondBlock = _mm256_loadu_si256((const __m256i *)(second + start));
+        unsigned int mask = ~(unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(firstBlock, secondBlock));
+        if (mask == 0)
+            continue;
+
+        if (diff->firstOffset < 0)
+            diff->firstOffset = start + __builtin_ctz(mask);
+        diff->lastOffset = start + 31 - __builtin_clz(mask);
+        diff->mismatches += __builtin_popcount(mask);
+        __m256i delta = _mm256_or_si256(_mm256_subs_epu8(firstBlock, secondBlock), _mm256_subs_epu8(secondBlock, firstBlock));
+        __m256i low = _mm256_unpacklo_epi8(delta, zero), high = _mm256_unpackhi_epi8(delta, zero);
+        largest = _mm256_max_epu8(largest, delta);
+        squares = _mm256_add_epi32(squares, _mm256_add_epi32(_mm256_madd_epi16(low, low), _mm256_madd_epi16(high, high)));
+        if (++blocks == DIFF_SQUARE_BLOCKS)
+        {
+            _mm256_storeu_si256((__m256i *)sums, squares);
+            addDiffSquares(diff, sums, 8);
+            squares = zero;
+            blocks = 0;
+        }
+    }
+    _mm256_storeu_si256((__m256i *)sums, squares);
+    addDiffSquares(diff, sums, 8);
+    _mm256_storeu_si256((__m256i *)bytes, largest);
+    addDiffLargest(diff, bytes, 32);
+
+    struct PixelDiff tail;
+    diffPixelsSse2(first + start, second + start, count - start, &tail);
+    addPixelDiff(diff, &tail, start);
+}
+#endif
+
+static PixelDiffKernel pixelDiffKernel = NULL;
+static pthread_once_t pixelDiffOnce = PTHREAD_ONCE_INIT;
+
+// This function picks the fastest kernel the processor supports, or the one DIFF_KERNEL forces.
+static void pickPixelDiffKernel(void)
+{
+    pixelDiffKernel = diffPixelsScalar;
+#ifdef PIXEL_X86_DIFF_KERNELS
+    const PixelDiffKernel kernels[] = {diffPixelsScalar, diffPixelsSse2, diffPixelsAvx2};
+    pixelDiffKernel = kernels[pickImageKernel("DIFF_KERNEL")];
+#endif
+}
+
+// This function picks the kernel the first time any thread calls it.
+void selectPixelDiffKernel(void)
+{
+    pthread_once(&pixelDiffOnce, pickPixelDiffKernel);
+}
+
+// This function fills diff with how count pixels of first differ from those of second, in one pass over both.
+void diffPixels(const unsigned char *first, const unsigned char *second, long count, struct PixelDiff *diff)
+{
+    selectPixelDiffKernel();
+    pixelDiffKernel(first, second, count, diff);
+}
@@ -0,0 +1,36 @@
+#ifndef PIXEL_DIFF_H
+#define PIXEL_DIFF_H
+
+#include "image.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PIXEL_X86_DIFF_KERNELS 1
+#endif
+
+// How two runs of pixels differ. The offsets are of the first and last pixels which differ, or -1 when none do.
+typedef struct PixelDiff
+{
+    long mismatches;
+    long firstOffset, lastOffset;
+    unsigned long long squares;
+    int maxDelta;
+} PixelDiff;
+
+typedef void (*PixelDiffKernel)(const unsigned char *first, const unsigned char *second, long count, struct PixelDiff *diff);
+
+// This function is the comparison without a vector unit.
+void diffPixelsScalar(const unsigned char *first, const unsigned char *second, long count, struct PixelDiff *diff);
+
+#ifdef PIXEL_X86_DIFF_KERNELS
+// These functions do the same comparison with SSE2 and AVX2. The AVX2 kernel must only run where the processor has it.
+void diffPixelsSse2(const unsigned char *first, const unsigned char *second, long count, struct PixelDiff *diff);
+void diffPixelsAvx2(const unsigned char *first, const unsigned char *second, long count, struct PixelDiff *diff);
+#endif
+
+// This function picks the kernel diffPixels uses, honouring DIFF_KERNEL.
+void selectPixelDiffKernel(void);
+
+// This function fills diff with how count pixels of first differ from those of second.
+void diffPixels(const unsigned char *first, const unsigned char *second, long count, struct PixelDiff *diff);
+
+#endif
@@ -0,0 +1,248 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "streamComp.h"
+#include "imageStream.h"
+#include "imageHash.h"
+#include "pixelDiff.h"
+
+// How two images differ, gathered a run of pixels within a row at a time for --stats.
+typedef struct ImageDiff
+{
+    int height, width, otherHeight, otherWidth;
+    long position;
+    long mismatches;
+    unsigned long long squares;
+    int maxDelta;
+    int firstRow, firstColumn;
+    int top, bottom, left, right;
+} ImageDiff;
+
+// This function adds the next count pixels of two images to diff.
+// Each row is compared in one pass, and only a row which differs changes anything but the position.
+static void addImageDiff(struct ImageDiff *diff, const unsigned char *first, const unsigned char *second, long count)
+{
+    for (long done = 0; done < count;)
+    {
+        int row = (int)(diff->position / diff->width);
+        int column = (int)(diff->position % diff->width);
+        long take = diff->width - column < count - done ? diff->width - column : count - done;
+        struct PixelDiff part;
+        diffPixels(first + done, second + done, take, &part);
+        if (part.mismatches > 0)
+        {
+            if (diff->mismatches == 0)
+            {
+                diff->firstRow = diff->top = row;
+                diff->firstColumn = diff->left = diff->right = column + (int)part.firstOffset;
+            }
+            diff->bottom = row;
+            if (column + part.firstOffset < diff->left)
+                diff->left = column + (int)part.firstOffset;
+            if (column + part.lastOffset > diff->right)
+                diff->right = column + (int)part.lastOffset;
+            diff->mismatches += part.mismatches;
+            diff->squares += part.squares;
+            if (part.maxDelta > diff->maxDelta)
+                diff->maxDelta = part.maxDelta;
+        }
+        diff->position += take;
+        done += take;
+    }
+}
+
+// This function compares two images side by side a chunk at a time, setting different when they differ.
+// Without diff the second file is not read past the first chunk which differs, or past its header when
+// the dimensions differ, and with diff both files are read to the end and every chunk is added to it.
+// The first file is always read to its end, even once the images are known to differ: a comp tool must
+// report bad data anywhere in the first file ahead of any answer, as the tools which loaded it whole did.
+// Only the second file's reading can stop early, so its errors past the first difference go unreported.
+static int compareImageStreams(const char *fileName1, const char *fileName2, unsigned short magicNumber, struct ImageDiff *diff, int *different)
+{
+    struct ImageReader first, second;
+    initImageReader(&first);
+    initImageReader(&second);
+    int check = openImageReader(&first, fileName1, magicNumber);
+    if (check != SUCCESS)
+    { // check first file
+        freeImageReader(&first);
+        reportImageError(check, fileName1);
+        return check;
+    } // check first file
+
+    unsigned char *chunk1 = (unsigned char *)malloc(STREAM_CHUNK_PIXELS);
+    unsigned char *chunk2 = (unsigned char *)malloc(STREAM_CHUNK_PIXELS);
+    if (chunk1 == NULL || chunk2 == NULL)
+    { // check malloc
+        free(chunk1);
+        free(chunk2);
+        closeImageReader(&first);
+        freeImageReader(&first);
+        printf("ERROR: Image Malloc Failed\n");
+        return BAD_MALLOC;
+    } // check malloc
+
+    // any error in the second file is held back until the first file is known to be good
+    int check2 = openImageReader(&second, fileName2, magicNumber);
+    int secondOpen = check2 == SUCCESS;
+    int comparing = secondOpen;
+    *different = 0;
+
+    // compare the headers before touching any pixel data
+    if (diff != NULL)
+    {
+        memset(diff, 0, sizeof(*diff));
+        diff->height = first.header.height;
+        diff->width = first.header.width;
+    }
+    if (comparing && (first.header.height != second.header.height || first.header.width != second.header.width))
+    {
+        *different = 1;
+        comparing = 0;
+        if (diff != NULL)
+        {
+            diff->otherHeight = second.header.height;
+            diff->otherWidth = second.header.width;
+        }
+    }
+
+    while (first.pixelsLeft > 0 && check == SUCCESS)
+    {
+        long count = first.pixelsLeft < STREAM_CHUNK_PIXELS ? first.pixelsLeft : STREAM_CHUNK_PIXELS;
+        check = readImagePixels(&first, chunk1, count);
+        if (check != SUCCESS || !comparing)
+            continue;
+
+        // stop reading the second file at its first bad chunk, or its first different one without diff
+        check2 = readImagePixels(&second, chunk2, count);
+        if (check2 != SUCCESS)
+            comparing = 0;
+        else if (diff != NULL)
+            addImageDiff(diff, chunk1, chunk2, count);
+        else if (memcmp(chunk1, chunk2, count) != 0)
+        {
+            *different = 1;
+            comparing = 0;
+        }
+    }
+    if (check == SUCCESS)
+        check = finishImageReader(&first);
+    if (comparing)
+        check2 = finishImageReader(&second);
+
+    closeImageReader(&first);
+    if (secondOpen)
+        closeImageReader(&second);
+    freeImageReader(&first);
+    freeImageReader(&second);
+    free(chunk1);
+    free(chunk2);
+
+    if (check != SUCCESS)
+    { // check first file
+        reportImageError(check, fileName1);
+        return check;
+    } // check first file
+    if (check2 != SUCCESS)
+    { // check second file
+        reportImageError(check2, fileName2);
+        return check2;
+    } // check second file
+    if (diff != NULL && diff->mismatches > 0)
+        *different = 1;
+    return SUCCESS;
+}
+
+// This function prints IDENTICAL or DIFFERENT for two images of the same format. With a magic number
+// of 0 each file is taken in its own format, so only the decoded pixels are compared.
+// Both files are read side by side a chunk at a time, so only two chunks of pixels are held however big
+// the images are, and the second file is not read past the first chunk which differs.
+int compareImageFiles(const char *fileName1, const char *fileName2, unsigned short magicNumber)
+{
+    int different;
+    int check = compareImageStreams(fileName1, fileName2, magicNumber, NULL, &different);
+    if (check != SUCCESS)
+        return check;
+    printf(different ? "DIFFERENT\n" : "IDENTICAL\n");
+    return SUCCESS;
+}
+
+// This function prints IDENTICAL or DIFFERENT for two images followed by how they differ: the number of
+// pixels which differ, the row and column of the first, the rows and columns of the box around them all,
+// the largest difference and the peak signal to noise ratio against the largest grey value, 31.
+// Images of different dimensions only have their dimensions printed.
+int compareImageStats(const char *fileName1, const char *fileName2, unsigned short magicNumber)
+{
+    struct ImageDiff diff;
+    int different;
+    int check = compareImageStreams(fileName1, fileName2, magicNumber, &diff, &different);
+    if (check != SUCCESS)
+        return check;
+    printf(different ? "DIFFERENT\n" : "IDENTICAL\n");
+    if (diff.position == 0)
+    { // dimensions differ
+        printf("dimensions: %d %d and %d %d\n", diff.height, diff.width, diff.otherHeight, diff.otherWidth);
+        return SUCCESS;
+    } // dimensions differ
+
+    printf("mismatches: %ld of %ld\n", diff.mismatches, diff.position);
+    if (diff.mismatches == 0)
+    {
+        printf("psnr: inf\n");
+        return SUCCESS;
+    }
+    double meanSquare = (double)diff.squares / (double)diff.position;
+    printf("first: row %d column %d\n", diff.firstRow, diff.firstColumn);
+    printf("box: rows %d to %d columns %d to %d\n", diff.top, diff.bottom, diff.left, diff.right);
+    printf("max delta: %d\n", diff.maxDelta);
+    printf("psnr: %.2f dB\n", 10.0 * log10(31.0 * 31.0 / meanSquare));
+    return SUCCESS;
+}
+
+// This function prints IDENTICAL or DIFFERENT for two images by their content hashes.
+// The errors are those of compareImageFiles, and the second file is not read when the dimensions differ.
+// With cache set, the hash of the first file, the reference, comes from its sidecar when it is current and is
+// saved otherwise. The second file is always read, so comparing candidates leaves no sidecars beside them.
+int compareImageHashes(const char *fileName1, const char *fileName2, unsigned short magicNumber, int cache)
+{
+    struct ImageDigest first, second;
+    int check = digestImageFile(fileName1, magicNumber, cache, NULL, &first);
+    if (check != SUCCESS)
+    { // check first file
+        reportImageError(check, fileName1);
+        return check;
+    } // check first file
+    check = digestImageFile(fileName2, magicNumber, 0, &first, &second);
+    if (check != SUCCESS)
+    { // check second file
+        reportImageError(check, fileName2);
+        return check;
+    } // check second file
+
+    int different = first.height != second.height || first.width != second.width || first.hash != second.hash;
+    printf(different ? "DIFFERENT\n" : "IDENTICAL\n");
+    return SUCCESS;
+}
+
+// This function returns the comparison an option names, --hash, --cache or --stats, or -1.
+int findCompareMode(const char *option)
+{
+    if (strcmp(option, "--hash") == 0)
+        return COMPARE_HASH;
+    if (strcmp(option, "--cache") == 0)
+        return COMPARE_CACHED_HASH;
+    if (strcmp(option, "--stats") == 0)
+        return COMPARE_STATS;
+    return -1;
+}
+
+// This function runs a comp tool's comparison of two images in the given mode.
+int compareImagesBy(const char *fileName1, const char *fileName2, unsigned short magicNumber, int mode)
+{
+    if (mode == COMPARE_PIXELS)
+        return compareImageFiles(fileName1, fileName2, magicNumber);
+    if (mode == COMPARE_STATS)
+        return compareImageStats(fileName1, fileName2, magicNumber);
+    return compareImageHashes(fileName1, fileName2, magicNumber, mode == COMPARE_CACHED_HASH);
+}
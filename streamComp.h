@@ -0,0 +1,28 @@
+#ifndef STREAM_COMP_H
+#define STREAM_COMP_H
+
+// Ways a comp tool can compare two images: pixel by pixel, by content hash, by content hash with the
+// reference's kept in a sidecar next to it so that a reference compared again and again is only read once,
+// or pixel by pixel reporting how much they differ.
+#define COMPARE_PIXELS 0
+#define COMPARE_HASH 1
+#define COMPARE_CACHED_HASH 2
+#define COMPARE_STATS 3
+
+// This function prints IDENTICAL or DIFFERENT for two images of the same format, or of any formats
+// when the magic number is 0, or the usual error.
+int compareImageFiles(const char *fileName1, const char *fileName2, unsigned short magicNumber);
+
+// This function prints IDENTICAL or DIFFERENT for two images followed by how much they differ.
+int compareImageStats(const char *fileName1, const char *fileName2, unsigned short magicNumber);
+
+// This function prints IDENTICAL or DIFFERENT for two images by their content hashes.
+int compareImageHashes(const char *fileName1, const char *fileName2, unsigned short magicNumber, int cache);
+
+// This function returns the comparison an option names, --hash, --cache or --stats, or -1.
+int findCompareMode(const char *option);
+
+// This function runs a comp tool's comparison of two images in the given mode.
+int compareImagesBy(const char *fileName1, const char *fileName2, unsigned short magicNumber, int mode);
+
+#endif
@@ -0,0 +1,342 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include "streamConvert.h"
+#include "imageArena.h"
+#include "stripRing.h"
+
+// The encoding and writing half of a pipelined conversion, which runs on a thread of its own.
+typedef struct WriteStage
+{
+    struct StripRing *ring;
+    struct ImageWriter *writer;
+    const char *outputName;
+    unsigned short outputMagic;
+    int height, width;
+    int check, writerOpen;
+} WriteStage;
+
+// This function removes an output file left partly written by an error after it was created.
+// Only a regular file is removed, so an output such as /dev/null is left where it is.
+static void removePartialOutput(const char *outputName)
+{
+    struct stat status;
+    if (outputName != NULL && stat(outputName, &status) == 0 && S_ISREG(status.st_mode))
+        unlink(outputName);
+}
+
+// This function converts the image an open reader is at, and closes the reader.
+// The output is created like in convertImageStream, in memory when outputName is NULL.
+static int convertOpenImage(struct ImageReader *reader, struct ImageWriter *writer, unsigned char *strip,
+                            const char *outputName, unsigned short outputMagic, const char **failedName)
+{
+    int check = SUCCESS;
+    long stripPixels = STREAM_STRIP_PIXELS / reader->header.width * reader->header.width;
+    int writerOpen = 0;
+    while (reader->pixelsLeft > 0 && check == SUCCESS)
+    {
+        long count = stripPixels < reader->pixelsLeft ? stripPixels : reader->pixelsLeft;
+        check = readImagePixels(reader, strip, count);
+
+        // trailing data is found before the output is created when the image fits in one strip
+        if (check == SUCCESS && reader->pixelsLeft == 0)
+            check = finishImageReader(reader);
+
+        if (check == SUCCESS && !writerOpen)
+        {
+            check = openImageWriter(writer, outputName, outputMagic, reader->header.height, reader->header.width);
+            writerOpen = check == SUCCESS;
+            // once the input is open, only the output file can have a bad name
+            if (check == BAD_FILE)
+                *failedName = outputName;
+        }
+        if (check == SUCCESS)
+            check = writeImagePixels(writer, strip, count);
+    }
+
+    if (writerOpen)
+    {
+        int closed = closeImageWriter(writer);
+        if (check == SUCCESS)
+            check = closed;
+        if (check != SUCCESS)
+            removePartialOutput(outputName);
+    }
+    closeImageReader(reader);
+    return check;
+}
+
+// This function is the body of the write stage. It takes strips off the ring in order, creating the output
+// with the first, and encodes and writes each one. Once a strip cannot be written it takes no more,
+// and stops the ring so that the read stage does not read the rest of the image for nothing.
+static void *runWriteStage(void *argument)
+{
+    struct WriteStage *stage = (struct WriteStage *)argument;
+    unsigned char *strip;
+    long count;
+    while (stage->check == SUCCESS && (strip = takeStrip(stage->ring, &count)) != NULL)
+    {
+        if (!stage->writerOpen)
+        {
+            stage->check = openImageWriter(stage->writer, stage->outputName, stage->outputMagic, stage->height, stage->width);
+            stage->writerOpen = stage->check == SUCCESS;
+        }
+        if (stage->check == SUCCESS)
+            stage->check = writeImagePixels(stage->writer, strip, count);
+        releaseStrip(stage->ring);
+    }
+    if (stage->check != SUCCESS)
+        stopStripRing(stage->ring);
+    return NULL;
+}
+
+// This function returns 1 when a conversion should run as a pipeline, which is when there is a second
+// processor for the write stage, unless IMAGE_PIPELINE is on or off.
+static int usePipeline(void)
+{
+    const char *forced = getenv("IMAGE_PIPELINE");
+    if (forced != NULL)
+        return strcmp(forced, "on") == 0;
+    return sysconf(_SC_NPROCESSORS_ONLN) > 1;
+}
+
+// This function converts the image an open reader is at like convertOpenImage, but as a pipeline of two stages
+// joined by a ring of STRIP_RING_SLOTS strips. This thread reads, decodes and checks each strip while a thread
+// of its own encodes and writes the strips before it, so the file reads, the parsing and checking, the packing
+// and the file writes all overlap, and a large image takes about as long as its slower half rather than both.
+// The output is created with the first strip, the strips are written in order, and when both stages fail
+// the write stage's error is the one reported, since it is always about an earlier strip. So the results
+// are exactly those of convertOpenImage, and likewise no partly written output is left after an error.
+// An image which fits in one strip has nothing to overlap and is converted by convertOpenImage.
+static int convertImageStages(struct ImageReader *reader, struct ImageWriter *writer, unsigned char *strip,
+                              const char *outputName, unsigned short outputMagic, const char **failedName)
+{
+    long stripPixels = STREAM_STRIP_PIXELS / reader->header.width * reader->header.width;
+    if (reader->pixelsLeft <= stripPixels)
+        return convertOpenImage(reader, writer, strip, outputName, outputMagic, failedName);
+
+    // the caller's strip is the first of the ring's, and the rest come from the arena
+    unsigned char *strips[STRIP_RING_SLOTS];
+    size_t capacities[STRIP_RING_SLOTS];
+    strips[0] = strip;
+    int ready = 1;
+    for (int slot = 1; slot < STRIP_RING_SLOTS; slot++)
+    {
+        strips[slot] = (unsigned char *)checkOutImageBlock(STREAM_STRIP_PIXELS, &capacities[slot]);
+        ready = ready && strips[slot] != NULL;
+    }
+
+    struct StripRing ring;
+    struct WriteStage stage = {&ring, writer, outputName, outputMagic, reader->header.height, reader->header.width, SUCCESS, 0};
+    pthread_t thread;
+    if (ready)
+        initStripRing(&ring, strips);
+    // without the strips or the thread the conversion simply runs one strip after another
+    int check = SUCCESS;
+    if (!ready || pthread_create(&thread, NULL, runWriteStage, &stage) != 0)
+        check = convertOpenImage(reader, writer, strip, outputName, outputMagic, failedName);
+    else
+    {
+        unsigned char *next;
+        while (reader->pixelsLeft > 0 && check == SUCCESS && (next = claimStrip(&ring)) != NULL)
+        {
+            long count = stripPixels < reader->pixelsLeft ? stripPixels : reader->pixelsLeft;
+            check = readImagePixels(reader, next, count);
+            if (check == SUCCESS && reader->pixelsLeft == 0)
+                check = finishImageReader(reader);
+            if (check == SUCCESS)
+                publishStrip(&ring, count);
+        }
+        finishStripRing(&ring);
+        pthread_join(thread, NULL);
+
+        if (stage.check != SUCCESS)
+            check = stage.check;
+        // once the input is open, only the output file can have a bad name
+        if (stage.check == BAD_FILE)
+            *failedName = outputName;
+        if (stage.writerOpen)
+        {
+            int closed = closeImageWriter(writer);
+            if (check == SUCCESS)
+                check = closed;
+            if (check != SUCCESS)
+                removePartialOutput(outputName);
+        }
+        closeImageReader(reader);
+    }
+
+    for (int slot = 1; slot < STRIP_RING_SLOTS; slot++)
+        if (strips[slot] != NULL)
+            returnImageBlock(strips[slot], capacities[slot]);
+    return check;
+}
+
+// This function converts an image from one format to another a strip of whole rows at a time,
+// so memory use depends on the width of the image but never on its height.
+// The reader, writer and strip are supplied by the caller so that they can be reused from file to file.
+// The output file is only created once the first strip has been read, so an image which fits in
+// one strip reports every input error before anything is written, just as loading it whole did,
+// and an output file which a later strip fails part way through is removed again.
+// Nothing is printed. On failure failedName is set to the file the error code is about.
+int convertImageStream(struct ImageReader *reader, struct ImageWriter *writer, unsigned char *strip,
+                       const char *inputName, unsigned short inputMagic, const char *outputName, unsigned short outputMagic,
+                       const char **failedName)
+{
+    *failedName = inputName;
+    int check = openImageReader(reader, inputName, inputMagic);
+    if (check != SUCCESS)
+        return check;
+    return convertOpenImage(reader, writer, strip, outputName, outputMagic, failedName);
+}
+
+// This function converts an image held in memory into the memory set on the writer by setImageWriterMemory,
+// with a reader, writer and strip supplied by the caller like convertImageStream, so that a caller converting
+// many small images allocates nothing per image. A magic number of 0 takes the input in whatever format it
+// is in. Nothing is printed, and the output is at writer->memory, writer->memoryUsed bytes long.
+int convertImageBytes(struct ImageReader *reader, struct ImageWriter *writer, unsigned char *strip,
+                      const unsigned char *input, size_t inputSize, unsigned short inputMagic, unsigned short outputMagic)
+{
+    const char *failedName = NULL;
+    int check = openImageReaderMemory(reader, input, inputSize, inputMagic);
+    if (check != SUCCESS)
+        return check;
+    return convertOpenImage(reader, writer, strip, NULL, outputMagic, &failedName);
+}
+
+// This function converts an image held in memory to another format in memory, a strip at a time like
+// convertImageStream, without touching the file system. A magic number of 0 takes the input in whatever
+// format it is in. When *output is a block of the caller's the image must fit in its *size bytes, and
+// when it is NULL a block is malloced for it, which the caller frees. Either way *size is set to the
+// length of the image. Nothing is printed, and BAD_OUTPUT means the caller's block was too small.
+int convertImageMemory(const unsigned char *input, size_t inputSize, unsigned short inputMagic, unsigned short outputMagic,
+                       unsigned char **output, size_t *size)
+{
+    struct ImageReader reader;
+    struct ImageWriter writer;
+    initImageReader(&reader);
+    initImageWriter(&writer);
+    setImageWriterMemory(&writer, *output, *size);
+
+    unsigned char *strip = (unsigned char *)malloc(STREAM_STRIP_PIXELS);
+    int check = strip == NULL ? BAD_MALLOC : convertImageBytes(&reader, &writer, strip, input, inputSize, inputMagic, outputMagic);
+    if (check == SUCCESS)
+    {
+        // the block is handed over rather than freed with the writer
+        *output = writer.memory;
+        *size = writer.memoryUsed;
+        writer.memory = NULL;
+        writer.memoryOwned = 0;
+    }
+
+    free(strip);
+    freeImageReader(&reader);
+    freeImageWriter(&writer);
+    return check;
+}
+
+// This function converts one image file, printing CONVERTED or the usual error message.
+// An output which is the input would be truncated before it was read, so it is refused as a bad file name.
+int convertImageFile(const char *inputName, unsigned short inputMagic, const char *outputName, unsigned short outputMagic)
+{
+    struct ImageReader reader;
+    struct ImageWriter writer;
+    initImageReader(&reader);
+    initImageWriter(&writer);
+
+    // a single large image is converted as a pipeline where there is a processor for each stage
+    const char *failedName = inputName;
+    size_t stripCapacity;
+    unsigned char *strip = (unsigned char *)checkOutImageBlock(STREAM_STRIP_PIXELS, &stripCapacity);
+    int check = strip == NULL ? BAD_MALLOC : SUCCESS;
+    if (check == SUCCESS && isSameFile(inputName, outputName))
+    {
+        check = BAD_FILE;
+        failedName = outputName;
+    }
+    if (check == SUCCESS)
+        check = openImageReader(&reader, inputName, inputMagic);
+    if (check == SUCCESS && usePipeline())
+        check = convertImageStages(&reader, &writer, strip, outputName, outputMagic, &failedName);
+    else if (check == SUCCESS)
+        check = convertOpenImage(&reader, &writer, strip, outputName, outputMagic, &failedName);
+
+    returnImageBlock(strip, stripCapacity);
+    freeImageReader(&reader);
+    freeImageWriter(&writer);
+    if (check != SUCCESS)
+    {
+        reportImageError(check, failedName);
+        return check;
+    }
+
+    // print final success message and return
+    printf("CONVERTED\n");
+    return SUCCESS;
+}
+
+// This function returns 1 when both names refer to the same existing file.
+int isSameFile(const char *fileName1, const char *fileName2)
+{
+    struct stat status1, status2;
+    return stat(fileName1, &status1) == 0 && stat(fileName2, &status2) == 0 &&
+           status1.st_dev == status2.st_dev && status1.st_ino == status2.st_ino;
+}
+
+// This function converts inputName to outputName whatever their formats, in one streaming pass.
+// Each strip is decoded, checked and encoded in turn, so no intermediate file or whole image is ever made.
+// The output format comes from its extension. The input format comes from its extension too, so a file
+// of the wrong format is reported as a bad magic number, and otherwise from its magic number.
+int transcodeImageFile(const char *inputName, const char *outputName)
+{
+    const struct ImageCodec *outputCodec = findImageCodecByExtension(outputName);
+    if (outputCodec == NULL)
+    {
+        printf("ERROR: Bad Arguments\n");
+        return BAD_ARGS;
+    }
+
+    int check = SUCCESS;
+    const struct ImageCodec *inputCodec = findImageCodecByExtension(inputName);
+    if (inputCodec == NULL)
+        inputCodec = detectImageCodec(inputName, &check);
+    if (inputCodec == NULL)
+    {
+        reportImageError(check, inputName);
+        return check;
+    }
+    return convertImageFile(inputName, inputCodec->magicNumber, outputName, outputCodec->magicNumber);
+}
+
+// This function reads a whole image into memory and writes it back out in the same format.
+// Every input error is found before the output file is created.
+int echoImageFile(const char *inputName, const char *outputName, unsigned short magicNumber)
+{
+    struct ImageFileInfo imageFileInfo;
+    initImageFileInfo(&imageFileInfo);
+    int check = loadImageFile(&imageFileInfo, inputName, magicNumber);
+    if (check != SUCCESS)
+    {
+        reportImageError(check, inputName);
+        return check;
+    }
+
+    // a view into the input would lose its pages when writing truncates the same file
+    if (isSameFile(inputName, outputName))
+        check = detachImageData(&imageFileInfo);
+    if (check == SUCCESS)
+        check = writeImageFile(&imageFileInfo, outputName, magicNumber);
+    clearImageData(&imageFileInfo);
+    if (check != SUCCESS)
+    {
+        reportImageError(check, outputName);
+        return check;
+    }
+
+    // print final success message and return
+    printf("ECHOED\n");
+    return SUCCESS;
+}
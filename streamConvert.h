@@ -0,0 +1,35 @@
+#ifndef STREAM_CONVERT_H
+#define STREAM_CONVERT_H
+
+#include "imageStream.h"
+
+// Size of the strip buffer a converter needs. A strip holds as many whole rows as fit in one chunk,
+// and since no row is longer than a chunk this is always at least one row.
+#define STREAM_STRIP_PIXELS STREAM_CHUNK_PIXELS
+
+// This function converts an image a strip of rows at a time with a reader, writer and strip supplied by the caller.
+int convertImageStream(struct ImageReader *reader, struct ImageWriter *writer, unsigned char *strip,
+                       const char *inputName, unsigned short inputMagic, const char *outputName, unsigned short outputMagic,
+                       const char **failedName);
+
+// This function converts an image held in memory into the writer's memory with a reader, writer and strip supplied by the caller.
+int convertImageBytes(struct ImageReader *reader, struct ImageWriter *writer, unsigned char *strip,
+                      const unsigned char *input, size_t inputSize, unsigned short inputMagic, unsigned short outputMagic);
+
+// This function converts an image held in memory to another format in memory, without touching the file system.
+int convertImageMemory(const unsigned char *input, size_t inputSize, unsigned short inputMagic, unsigned short outputMagic,
+                       unsigned char **output, size_t *size);
+
+// This function converts one image file, printing CONVERTED or the usual error message.
+int convertImageFile(const char *inputName, unsigned short inputMagic, const char *outputName, unsigned short outputMagic);
+
+// This function converts between any two formats, which are taken from the file extensions, printing CONVERTED or the usual error.
+int transcodeImageFile(const char *inputName, const char *outputName);
+
+// This function returns 1 when both names refer to the same existing file.
+int isSameFile(const char *fileName1, const char *fileName2);
+
+// This function reads a whole image and writes it back out in the same format, printing ECHOED or the usual error message.
+int echoImageFile(const char *inputName, const char *outputName, unsigned short magicNumber);
+
+#endif
@@ -0,0 +1,123 @@
+// syscall is only declared for the default feature set
+#define _DEFAULT_SOURCE
+
+#include <limits.h>
+#include <sched.h>
+#include <unistd.h>
+#include "stripRing.h"
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
+// This function sets up an empty ring over STRIP_RING_SLOTS strip buffers.
+void initStripRing(struct StripRing *ring, unsigned char **strips)
+{
+    ring->head = ring->tail = ring->events = 0;
+    ring->sleepers = ring->finished = ring->stopped = 0;
+    for (int slot = 0; slot < STRIP_RING_SLOTS; slot++)
+    {
+        ring->strips[slot] = strips[slot];
+        ring->counts[slot] = 0;
+    }
+}
+
+// This function waits until the event count of a ring moves on from seen.
+// The other stage usually moves within a strip's time, so the ring is checked a few times before sleeping.
+static void sleepStripRing(struct StripRing *ring, unsigned seen)
+{
+    for (int spin = 0; spin < STRIP_RING_SPINS; spin++)
+    {
+        if (__atomic_load_n(&ring->events, __ATOMIC_SEQ_CST) != seen)
+            return;
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+
+    // the sleeper is counted before the kernel checks the count again, so a move either shows up
+    // in that check or sees the sleeper and wakes it
+    __atomic_fetch_add(&ring->sleepers, 1, __ATOMIC_SEQ_CST);
+#ifdef __linux__
+    syscall(SYS_futex, &ring->events, FUTEX_WAIT_PRIVATE, seen, NULL, NULL, 0);
+#else
+    if (__atomic_load_n(&ring->events, __ATOMIC_SEQ_CST) == seen)
+        sched_yield();
+#endif
+    __atomic_fetch_sub(&ring->sleepers, 1, __ATOMIC_SEQ_CST);
+}
+
+// This function records that one side of a ring has moved and wakes the other if it is asleep.
+static void signalStripRing(struct StripRing *ring)
+{
+    __atomic_fetch_add(&ring->events, 1, __ATOMIC_SEQ_CST);
+#ifdef __linux__
+    if (__atomic_load_n(&ring->sleepers, __ATOMIC_SEQ_CST) > 0)
+        syscall(SYS_futex, &ring->events, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+#endif
+}
+
+// This function returns the next strip for the producer to fill, waiting while every strip is full.
+// It returns NULL once the consumer has stopped, and the producer should then stop too.
+unsigned char *claimStrip(struct StripRing *ring)
+{
+    for (;;)
+    {
+        unsigned seen = __atomic_load_n(&ring->events, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&ring->stopped, __ATOMIC_ACQUIRE))
+            return NULL;
+        if (ring->head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) < STRIP_RING_SLOTS)
+            return ring->strips[ring->head % STRIP_RING_SLOTS];
+        sleepStripRing(ring, seen);
+    }
+}
+
+// This function hands the strip just claimed, holding count pixels, to the consumer.
+void publishStrip(struct StripRing *ring, long count)
+{
+    ring->counts[ring->head % STRIP_RING_SLOTS] = count;
+    __atomic_store_n(&ring->head, ring->head + 1, __ATOMIC_RELEASE);
+    signalStripRing(ring);
+}
+
+// This function tells the consumer that no more strips are coming, once it has taken those already published.
+void finishStripRing(struct StripRing *ring)
+{
+    __atomic_store_n(&ring->finished, 1, __ATOMIC_RELEASE);
+    signalStripRing(ring);
+}
+
+// This function returns the next strip for the consumer and sets count to its pixels, waiting while there is none.
+// It returns NULL once the producer has finished and every strip it published has been taken.
+unsigned char *takeStrip(struct StripRing *ring, long *count)
+{
+    for (;;)
+    {
+        unsigned seen = __atomic_load_n(&ring->events, __ATOMIC_SEQ_CST);
+        // finished is read first, so a strip published before it was set is always found below
+        int finished = __atomic_load_n(&ring->finished, __ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) != ring->tail)
+        {
+            *count = ring->counts[ring->tail % STRIP_RING_SLOTS];
+            return ring->strips[ring->tail % STRIP_RING_SLOTS];
+        }
+        if (finished)
+            return NULL;
+        sleepStripRing(ring, seen);
+    }
+}
+
+// This function gives the strip just taken back to the producer.
+void releaseStrip(struct StripRing *ring)
+{
+    __atomic_store_n(&ring->tail, ring->tail + 1, __ATOMIC_RELEASE);
+    signalStripRing(ring);
+}
+
+// This function tells the producer that the consumer will take no more strips.
+void stopStripRing(struct StripRing *ring)
+{
+    __atomic_store_n(&ring->stopped, 1, __ATOMIC_RELEASE);
+    signalStripRing(ring);
+}
@@ -0,0 +1,51 @@
+#ifndef STRIP_RING_H
+#define STRIP_RING_H
+
+// Strips a ring holds between the stage which fills them and the stage which empties them.
+// It must be a power of two.
+#define STRIP_RING_SLOTS 4
+
+// Times a stage checks the ring again before it sleeps until the other stage moves.
+#define STRIP_RING_SPINS 256
+
+// A bounded ring of strips between exactly one producing stage and one consuming stage.
+// Each side moves only its own counter, so handing a strip over takes no lock, and a stage which has to
+// wait sleeps on the ring's event count, which the other side only has to wake when someone sleeps.
+typedef struct StripRing
+{
+    // strips published by the producer and given back by the consumer, each on its own cache line
+    unsigned head;
+    char headPadding[64 - sizeof(unsigned)];
+    unsigned tail;
+    char tailPadding[64 - sizeof(unsigned)];
+    // bumped whenever either side moves, and the number of stages asleep on it
+    unsigned events;
+    int sleepers;
+    // set once the producer has published its last strip, or the consumer will take no more
+    int finished, stopped;
+    unsigned char *strips[STRIP_RING_SLOTS];
+    long counts[STRIP_RING_SLOTS];
+} StripRing;
+
+// This function sets up an empty ring over the given strip buffers.
+void initStripRing(struct StripRing *ring, unsigned char **strips);
+
+// This function returns the next strip for the producer to fill, or NULL once the consumer has stopped.
+unsigned char *claimStrip(struct StripRing *ring);
+
+// This function hands the strip just claimed, holding count pixels, to the consumer.
+void publishStrip(struct StripRing *ring, long count);
+
+// This function tells the consumer that no more strips are coming.
+void finishStripRing(struct StripRing *ring);
+
+// This function returns the next strip for the consumer and its pixel count, or NULL once the ring is finished and empty.
+unsigned char *takeStrip(struct StripRing *ring, long *count);
+
+// This function gives the strip just taken back to the producer.
+void releaseStrip(struct StripRing *ring);
+
+// This function tells the producer that the consumer will take no more strips.
+void stopStripRing(struct StripRing *ring);
+
+#endif
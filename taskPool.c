@@ -0,0 +1,137 @@
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "taskPool.h"
+
+// The threads of the pool and the one set of tasks they are working through.
+// A set is started by bumping the generation, and every worker then takes indices until none are left.
+typedef struct TaskPool
+{
+    pthread_mutex_t lock;
+    pthread_cond_t wake, done;
+    // Held by whoever's set is running, so a second caller runs its set itself rather than waiting.
+    pthread_mutex_t submit;
+
+    PoolTask task;
+    void *argument;
+    long count;
+    // Next index to be taken, and the number of tasks which have finished.
+    long next, finished;
+    unsigned long generation;
+    // Workers which have joined a set and not yet reported back.
+    int active;
+    int threadCount;
+} TaskPool;
+
+static TaskPool taskPool = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_MUTEX_INITIALIZER};
+static pthread_once_t taskPoolOnce = PTHREAD_ONCE_INIT;
+
+// This function runs tasks of the current set until none are left and returns how many it ran.
+static long runPoolShare(void)
+{
+    long ran = 0;
+    for (;;)
+    {
+        long index = __atomic_fetch_add(&taskPool.next, 1, __ATOMIC_RELAXED);
+        if (index >= taskPool.count)
+            return ran;
+        taskPool.task(taskPool.argument, index);
+        ran++;
+    }
+}
+
+// This function is the body of every worker: wait for a set, help with it, report back.
+static void *runPoolWorker(void *unused)
+{
+    unsigned long seen = 0;
+    pthread_mutex_lock(&taskPool.lock);
+    for (;;)
+    {
+        while (taskPool.generation == seen)
+            pthread_cond_wait(&taskPool.wake, &taskPool.lock);
+        seen = taskPool.generation;
+        taskPool.active++;
+        pthread_mutex_unlock(&taskPool.lock);
+
+        long ran = runPoolShare();
+
+        pthread_mutex_lock(&taskPool.lock);
+        taskPool.finished += ran;
+        taskPool.active--;
+        if (taskPool.finished >= taskPool.count || taskPool.active == 0)
+            pthread_cond_broadcast(&taskPool.done);
+    }
+    return NULL;
+}
+
+// This function starts the workers, one fewer than the processors because the caller works too.
+// IMAGE_THREADS overrides the number of threads.
+static void startTaskPool(void)
+{
+    const char *forced = getenv("IMAGE_THREADS");
+    long threadCount = forced != NULL ? strtol(forced, NULL, 10) : sysconf(_SC_NPROCESSORS_ONLN);
+    if (threadCount > POOL_MAX_THREADS)
+        threadCount = POOL_MAX_THREADS;
+
+    // a worker which cannot be started is simply left out
+    taskPool.threadCount = 1;
+    for (long index = 1; index < threadCount; index++)
+    {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, runPoolWorker, NULL) != 0)
+            break;
+        pthread_detach(thread);
+        taskPool.threadCount++;
+    }
+}
+
+// This function returns the number of threads tasks are run on, counting the caller.
+int poolThreadCount(void)
+{
+    pthread_once(&taskPoolOnce, startTaskPool);
+    return taskPool.threadCount;
+}
+
+// This function returns how many pieces amount should be split into: one per thread, but no more
+// than leaves each piece at least least, and never fewer than one.
+int poolShareCount(long amount, long least)
+{
+    long shares = amount / least;
+    if (shares > poolThreadCount())
+        shares = poolThreadCount();
+    return shares < 1 ? 1 : (int)shares;
+}
+
+// This function runs task for every index from 0 to count - 1 and returns once they have all finished.
+// The caller takes tasks alongside the workers. Only one set runs on the pool at a time, so while
+// another thread's set is running, or when there is nothing to share, the tasks are run here in order.
+void runPoolTasks(PoolTask task, void *argument, long count)
+{
+    if (count <= 1 || poolThreadCount() <= 1 || pthread_mutex_trylock(&taskPool.submit) != 0)
+    {
+        for (long index = 0; index < count; index++)
+            task(argument, index);
+        return;
+    }
+
+    // workers still leaving the last set may be reading it, so wait for them before replacing it
+    pthread_mutex_lock(&taskPool.lock);
+    while (taskPool.active > 0)
+        pthread_cond_wait(&taskPool.done, &taskPool.lock);
+    taskPool.task = task;
+    taskPool.argument = argument;
+    taskPool.count = count;
+    taskPool.next = taskPool.finished = 0;
+    taskPool.generation++;
+    pthread_cond_broadcast(&taskPool.wake);
+    pthread_mutex_unlock(&taskPool.lock);
+
+    long ran = runPoolShare();
+
+    pthread_mutex_lock(&taskPool.lock);
+    taskPool.finished += ran;
+    while (taskPool.finished < count)
+        pthread_cond_wait(&taskPool.done, &taskPool.lock);
+    pthread_mutex_unlock(&taskPool.lock);
+    pthread_mutex_unlock(&taskPool.submit);
+}
@@ -0,0 +1,19 @@
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+// Most threads the pool runs, counting the one which hands it work.
+#define POOL_MAX_THREADS 64
+
+// One task of a set, given the argument shared by the set and its own index.
+typedef void (*PoolTask)(void *argument, long index);
+
+// This function returns the number of threads tasks are run on, counting the caller.
+int poolThreadCount(void);
+
+// This function returns how many pieces amount should be split into so that each thread has at least least of it.
+int poolShareCount(long amount, long least);
+
+// This function runs task for every index from 0 to count - 1 and returns once they have all finished.
+void runPoolTasks(PoolTask task, void *argument, long count);
+
+#endif
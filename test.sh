@@ -193,21 +193,34 @@ do
     echo "Bad Malloc (dims too high to allocate)"
     filename="bad_malloc"
     full_path=$path$filename$file_ext
-    run_test ./$testExecutable $full_path "tmp" 5  "ERROR: Image Malloc Failed"
+    # ebu pixels are a view into the mapped file rather than an allocation, and the comparators
+    # and converters stream their images a strip at a time, so in those cases a header asking for
+    # more pixels than the file holds is reported as bad data instead.
+    if [[ $file_ext == ".ebu" || ${testExecutable:3:4} == "Comp" || ${testExecutable:3:1} == "2" ]]
+    then
+        run_test ./$testExecutable $full_path "tmp" 6 "ERROR: Bad Data ($full_path)"
+    else
+        run_test ./$testExecutable $full_path "tmp" 5  "ERROR: Image Malloc Failed"
+    fi
 
-    # data has a greyvalue above the maximum permitted value
-    echo ""
-    echo "Bad Data (too high)"
-    filename="bad_data_high"
-    full_path=$path$filename$file_ext
-    run_test ./$testExecutable $full_path "tmp" 6 "ERROR: Bad Data ($full_path)"
+    # ebc packs each greyvalue into 5 bits, so every value it can hold is between 0 and 31
+    # and the range tests only apply to the other formats.
+    if [[ $file_ext != ".ebc" ]]
+    then
+        # data has a greyvalue above the maximum permitted value
+        echo ""
+        echo "Bad Data (too high)"
+        filename="bad_data_high"
+        full_path=$path$filename$file_ext
+        run_test ./$testExecutable $full_path "tmp" 6 "ERROR: Bad Data ($full_path)"
 
-    # data has a greyvalue below the minimum permitted value
-    echo ""
-    echo "Bad Data (too low)"
-    filename="bad_data_low"
-    full_path=$path$filename$file_ext
-    run_test ./$testExecutable $full_path "tmp" 6 "ERROR: Bad Data ($full_path)"
+        # data has a greyvalue below the minimum permitted value
+        echo ""
+        echo "Bad Data (too low)"
+        filename="bad_data_low"
+        full_path=$path$filename$file_ext
+        run_test ./$testExecutable $full_path "tmp" 6 "ERROR: Bad Data ($full_path)"
+    fi
 
     # too many greyvalues compared to the actual dimensions of the file
     echo ""
@@ -318,8 +331,291 @@ do
             echo "CONVERTED FILES ARE IDENTICAL"
         fi
     fi
-    
+
+done
+
+# tests holds no tiled or compressed images, so they are made from the ebc ones in a folder of their own,
+# with a compressed image cut short for bad data, and image_dir gives the folder holding the images of a format.
+mkdir -p tmp_data/ebt_data tmp_data/ebz_data
+./ebconvert tests/data/ebc_data/good.ebc tmp_data/ebt_data/good.ebt > null
+./ebconvert tests/data/ebc_data/good.ebc tmp_data/ebz_data/good.ebz > null
+head -c 30000 tmp_data/ebz_data/good.ebz > tmp_data/ebz_data/bad_data.ebz
+image_dir() {
+    if [[ $1 = ebt || $1 = ebz ]]
+    then
+        echo "tmp_data/"$1"_data"
+    else
+        echo "tests/data/"$1"_data"
+    fi
+}
+
+# ebconvert takes both formats from the file extensions, so every pair of formats
+# is converted directly and compared to the identical file in the other format.
+# ebt is tiled ebc and ebz is compressed ebc, which have no echo, comp or convert tool of their own.
+echo "-------------- TESTING ebconvert --------------"
+run_test ./ebconvert "" "" 0 "Usage: ebconvert file1 file2"
+run_test ./ebconvert "1 2" "3" 1 "ERROR: Bad Arguments"
+run_test ./ebconvert "tests/data/ebf_data/good.ebf" "tmp" 1 "ERROR: Bad Arguments"
+run_test ./ebconvert "tmp_data/ebz_data/bad_data.ebz" "tmp.ebu" 6 "ERROR: Bad Data (tmp_data/ebz_data/bad_data.ebz)"
+rm -f "tmp.ebu"
+for from_ext in ebf ebu ebc ebt ebz
+do
+    for to_ext in ebf ebu ebc ebt ebz
+    do
+        if [[ $from_ext != $to_ext ]]
+        then
+            echo ""
+            echo "Testing ebconvert $from_ext to $to_ext"
+            run_test ./ebconvert "$(image_dir $from_ext)/good."$from_ext "tmp."$to_ext 0 "CONVERTED"
+            D=$(diff "$(image_dir $to_ext)/good."$to_ext "tmp."$to_ext)
+            if [[ $D != "" ]]
+            then
+                echo "CONVERTED FILES ARE DIFFERENT"
+                echo $D
+            else
+                echo "CONVERTED FILES ARE IDENTICAL"
+            fi
+            rm -f "tmp."$to_ext
+        fi
+    done
+done
+
+# ebcCrop reads a rectangle from ebc or tiled ebc, so cropping the whole of either
+# image gives back the identical file in the format of the output.
+echo "-------------- TESTING ebcCrop --------------"
+run_test ./ebcCrop "" "" 0 "Usage: ebcCrop file1 row column height width file2"
+run_test ./ebcCrop "tmp_data/ebt_data/good.ebt" "0 0" 1 "ERROR: Bad Arguments"
+run_test ./ebcCrop "tmp_data/ebt_data/good.ebt" "300 0 100 10 tmp.ebu" 4 "ERROR: Bad Dimensions (tmp_data/ebt_data/good.ebt)"
+run_test ./ebcCrop "tests/data/ebu_data/good.ebu" "0 0 1 1 tmp.ebu" 3 "ERROR: Bad Magic Number (tests/data/ebu_data/good.ebu)"
+for from_ext in ebc ebt
+do
+    echo ""
+    echo "Testing ebcCrop $from_ext"
+    run_test ./ebcCrop "$(image_dir $from_ext)/good."$from_ext "0 0 360 250 tmp.ebu" 0 "CROPPED"
+    D=$(diff "tests/data/ebu_data/good.ebu" "tmp.ebu")
+    if [[ $D != "" ]]
+    then
+        echo "CROPPED FILES ARE DIFFERENT"
+        echo $D
+    else
+        echo "CROPPED FILES ARE IDENTICAL"
+    fi
+    rm -f "tmp.ebu"
+done
+
+# ebhash prints the content hash of an image, which is the same whatever the format.
+# The comp tools compare content hashes with --hash, and with --cache they keep the hash of
+# the first image in a sidecar next to it, which a later comparison uses instead of the image.
+echo "-------------- TESTING ebhash and --hash --------------"
+run_test ./ebhash "" "" 0 "Usage: ebhash file"
+run_test ./ebhash "1 2" "3" 1 "ERROR: Bad Arguments"
+run_test ./ebhash "tests/data/ebf_data/bad_mn.ebf" "" 3 "ERROR: Bad Magic Number (tests/data/ebf_data/bad_mn.ebf)"
+for ext in ebf ebu ebc ebt ebz
+do
+    run_test ./ebhash "$(image_dir $ext)/good."$ext "" 0 "c1c09ab27308288c"
+done
+run_test ./ebfComp "--hsh tests/data/ebf_data/good.ebf" "tests/data/ebf_data/good.ebf" 1 "ERROR: Bad Arguments"
+for ext in ebf ebu ebc
+do
+    echo ""
+    echo "Testing "$ext"Comp --hash and --cache"
+    run_test ./$ext"Comp" "--hash tests/data/"$ext"_data/good."$ext "tests/data/"$ext"_data/good2."$ext 0 "IDENTICAL"
+    run_test ./$ext"Comp" "--hash tests/data/"$ext"_data/good."$ext "tests/data/"$ext"_data/good3."$ext 0 "DIFFERENT"
+    run_test ./$ext"Comp" "--hash tests/data/"$ext"_data/good."$ext "tests/data/"$ext"_data/bad_dims_low."$ext 4 "ERROR: Bad Dimensions (tests/data/"$ext"_data/bad_dims_low."$ext")"
+    cp "tests/data/"$ext"_data/good."$ext "tmp."$ext
+    run_test ./$ext"Comp" "--cache tmp."$ext "tests/data/"$ext"_data/good3."$ext 0 "DIFFERENT"
+    if [[ -f "tmp."$ext".ebh" ]]
+    then
+        echo "SIDECAR WRITTEN"
+    else
+        echo "SIDECAR MISSING"
+    fi
+    if [[ -f "tests/data/"$ext"_data/good3."$ext".ebh" ]]
+    then
+        echo "SIDECAR WRITTEN FOR SECOND FILE"
+        rm -f "tests/data/"$ext"_data/good3."$ext".ebh"
+    fi
+    run_test ./$ext"Comp" "--cache tmp."$ext "tests/data/"$ext"_data/good2."$ext 0 "IDENTICAL"
+    rm -f "tmp."$ext "tmp."$ext".ebh"
+done
+
+# ebComp compares two images of any formats by their decoded pixels, reading both side by side.
+echo "-------------- TESTING ebComp --------------"
+run_test ./ebComp "" "" 0 "Usage: ebComp file1 file2"
+run_test ./ebComp "1 2" "3" 1 "ERROR: Bad Arguments"
+run_test ./ebComp "tests/data/ebf_data/bad_mn.ebf" "tests/data/ebu_data/good.ebu" 3 "ERROR: Bad Magic Number (tests/data/ebf_data/bad_mn.ebf)"
+run_test ./ebComp "tests/data/ebf_data/good.ebf" "tests/data/ebu_data/bad_mn.ebu" 3 "ERROR: Bad Magic Number (tests/data/ebu_data/bad_mn.ebu)"
+run_test ./ebComp "tests/data/ebc_data/bad_data_much.ebc" "tests/data/ebf_data/good.ebf" 6 "ERROR: Bad Data (tests/data/ebc_data/bad_data_much.ebc)"
+for first in ebf ebu ebc ebt ebz
+do
+    for second in ebf ebu ebc ebt ebz
+    do
+        run_test ./ebComp "$(image_dir $first)/good."$first "$(image_dir $second)/good."$second 0 "IDENTICAL"
+    done
+done
+run_test ./ebComp "tests/data/ebf_data/good.ebf" "tests/data/ebc_data/good3.ebc" 0 "DIFFERENT"
+run_test ./ebComp "tests/data/ebu_data/good3.ebu" "tmp_data/ebz_data/good.ebz" 0 "DIFFERENT"
+run_test ./ebComp "--hash tests/data/ebc_data/good.ebc" "tests/data/ebf_data/good2.ebf" 0 "IDENTICAL"
+# the first image is read to its end whatever the second holds, but the second is not read past the first difference
+run_test ./ebComp "tests/data/ebc_data/bad_data_much.ebc" "tests/data/ebf_data/good3.ebf" 6 "ERROR: Bad Data (tests/data/ebc_data/bad_data_much.ebc)"
+run_test ./ebComp "tests/data/ebf_data/good3.ebf" "tests/data/ebc_data/bad_data_much.ebc" 0 "DIFFERENT"
+
+# --stats compares pixel by pixel like the plain comp tools but reads both images to the end
+# and reports how much they differ.
+echo "-------------- TESTING --stats --------------"
+run_test ./ebfComp "--stats tests/data/ebf_data/good.ebf" "tests/data/ebf_data/good3.ebf" 0 $'DIFFERENT\nmismatches: 1 of 90000\nfirst: row 0 column 3\nbox: rows 0 to 0 columns 3 to 3\nmax delta: 10\npsnr: 59.37 dB'
+run_test ./ebuComp "--stats tests/data/ebu_data/good.ebu" "tests/data/ebu_data/good3.ebu" 0 $'DIFFERENT\ndimensions: 360 250 and 1080 1920'
+run_test ./ebcComp "--stats tests/data/ebc_data/good.ebc" "tests/data/ebc_data/good2.ebc" 0 $'IDENTICAL\nmismatches: 0 of 90000\npsnr: inf'
+run_test ./ebComp "--stats tmp_data/ebz_data/good.ebz" "tests/data/ebf_data/good3.ebf" 0 $'DIFFERENT\nmismatches: 1 of 90000\nfirst: row 0 column 3\nbox: rows 0 to 0 columns 3 to 3\nmax delta: 10\npsnr: 59.37 dB'
+run_test ./ebComp "--stats tests/data/ebf_data/good.ebf" "tests/data/ebc_data/bad_data_much.ebc" 6 "ERROR: Bad Data (tests/data/ebc_data/bad_data_much.ebc)"
+
+# headers are parsed the way fscanf would, but a dimension or tile size too long for an int is out of range rather than overflowing
+echo "-------------- TESTING header dimensions --------------"
+printf "eb\n2 99999999999999999999\n1 2\n" > tmp.ebf
+run_test ./ebfEcho "tmp.ebf" "tmp2.ebf" 4 "ERROR: Bad Dimensions (tmp.ebf)"
+printf "eb\n 0000000000000000000001\n\t\n+2 1 2\n" > tmp.ebf
+run_test ./ebfEcho "tmp.ebf" "tmp2.ebf" 0 "ECHOED"
+printf "eu\n4294967297 1\n" > tmp.ebu
+run_test ./ebuEcho "tmp.ebu" "tmp2.ebu" 4 "ERROR: Bad Dimensions (tmp.ebu)"
+{ printf "et\n360 250\n4294967552\n"; tail -c +15 tmp_data/ebt_data/good.ebt; } > tmp.ebt
+run_test ./ebconvert "tmp.ebt" "tmp2.ebu" 4 "ERROR: Bad Dimensions (tmp.ebt)"
+rm -f tmp.ebf tmp2.ebf tmp.ebu tmp2.ebu tmp.ebt
+
+# echoing an image onto its own file leaves the file as it was, even when the image read is a view into that file,
+# but a conversion would truncate its input before reading it, so it refuses an output which is the input
+# by whatever name, whether or not it runs as a pipeline.
+echo "-------------- TESTING same input and output --------------"
+cp tests/data/ebu_data/good3.ebu tmp.ebu
+run_test ./ebuEcho "tmp.ebu" "tmp.ebu" 0 "ECHOED"
+run_test ./ebuComp "tmp.ebu" "tests/data/ebu_data/good3.ebu" 0 "IDENTICAL"
+for pipeline in on off
+do
+    export IMAGE_PIPELINE=$pipeline
+    run_test ./ebu2ebf "tmp.ebu" "tmp.ebu" 2 "ERROR: Bad File Name (tmp.ebu)"
+    run_test ./ebu2ebc "tmp.ebu" "./tmp.ebu" 2 "ERROR: Bad File Name (./tmp.ebu)"
+    run_test ./ebconvert "tmp.ebu" "tmp.ebu" 2 "ERROR: Bad File Name (tmp.ebu)"
+    run_test ./ebuComp "tmp.ebu" "tests/data/ebu_data/good3.ebu" 0 "IDENTICAL"
+done
+unset IMAGE_PIPELINE
+cp tests/data/ebf_data/good3.ebf tmp.ebf
+run_test ./ebfEcho "tmp.ebf" "tmp.ebf" 0 "ECHOED"
+run_test ./ebfComp "tmp.ebf" "tests/data/ebf_data/good3.ebf" 0 "IDENTICAL"
+cp tests/data/ebc_data/good.ebc tmp.ebc
+run_test ./ebcEcho "tmp.ebc" "tmp.ebc" 0 "ECHOED"
+run_test ./ebcComp "tmp.ebc" "tests/data/ebc_data/good.ebc" 0 "IDENTICAL"
+rm -f tmp.ebu tmp.ebf tmp.ebc
+
+# ebd runs the tools for ebdc clients over a unix socket, and ebdc prints what the tool would have printed
+# and returns what it would have returned.
+echo "-------------- TESTING ebd and ebdc --------------"
+run_test ./ebd "" "" 0 "Usage: ebd socket"
+run_test ./ebdc "" "" 0 "Usage: ebdc socket tool [arguments]"
+run_test ./ebdc "tmp.sock" "" 1 "ERROR: Bad Arguments"
+run_test ./ebdc "tmp.sock" "ebf2ebu" 2 "ERROR: Bad File Name (tmp.sock)"
+./ebd tmp.sock &
+DAEMON=$!
+for wait in 1 2 3 4 5 6 7 8 9 10
+do
+    if [[ -S tmp.sock ]]
+    then
+        break
+    fi
+    sleep 0.5
+done
+run_test ./ebdc "tmp.sock ebf2ebu" "" 0 "Usage: ebf2ebu file1 file2"
+run_test ./ebdc "tmp.sock ebfEcho" "1 2 3" 1 "ERROR: Bad Arguments"
+run_test ./ebdc "tmp.sock ebfNothing" "1 2" 1 "ERROR: Bad Arguments"
+run_test ./ebdc "tmp.sock ebf2ebu tests/data/ebf_data/good.ebf" "tmp.ebu" 0 "CONVERTED"
+run_test ./ebuComp "tmp.ebu" "tests/data/ebu_data/good.ebu" 0 "IDENTICAL"
+run_test ./ebdc "tmp.sock ebuEcho tests/data/ebu_data/bad_mn.ebu" "tmp.ebu" 3 "ERROR: Bad Magic Number (tests/data/ebu_data/bad_mn.ebu)"
+run_test ./ebdc "tmp.sock ebcEcho tests/data/ebc_data/bad_data_much.ebc" "tmp.ebc" 6 "ERROR: Bad Data (tests/data/ebc_data/bad_data_much.ebc)"
+run_test ./ebdc "tmp.sock ebconvert tmp_data/ebz_data/good.ebz" "tmp.ebc" 0 "CONVERTED"
+run_test ./ebdc "tmp.sock ebComp tmp.ebc" "tests/data/ebf_data/good.ebf" 0 "IDENTICAL"
+run_test ./ebdc "tmp.sock ebfComp --stats tests/data/ebf_data/good.ebf" "tests/data/ebf_data/good3.ebf" 0 $'DIFFERENT\nmismatches: 1 of 90000\nfirst: row 0 column 3\nbox: rows 0 to 0 columns 3 to 3\nmax delta: 10\npsnr: 59.37 dB'
+run_test ./ebdc "tmp.sock ebhash" "tmp_data/ebt_data/good.ebt" 0 "c1c09ab27308288c"
+kill $DAEMON
+wait $DAEMON 2>/dev/null
+rm -f tmp.sock tmp.ebu tmp.ebc
+
+# ebbatch reads small files whole through an io_uring, or with pread and pwrite without one, and streams
+# the rest, and every way prints the same results and writes the same files.
+echo "-------------- TESTING ebbatch --------------"
+run_test ./ebbatch "" "" 0 "Usage: ebbatch [-j threads] inputs format outputDirectory"
+run_test ./ebbatch "tests/data/ebf_data ebq" "." 1 "ERROR: Bad Arguments"
+printf "tests/data/ebf_data/good.ebf\ntests/data/ebc_data/bad_mn.ebc\nmissing.ebf\ntests/data/ebc_data/bad_data_much.ebc\ntmp_data/ebz_data/good.ebz\ntests/data/ebu_data/good3.ebu\n" > tmp.list
+mkdir -p tmp_batch
+for mode in uring pread stream
+do
+    export BATCH_IO=$mode
+    rm -f tmp_batch/*
+    echo "Testing ebbatch with BATCH_IO=$mode"
+    run_test ./ebbatch "tmp.list ebu" "tmp_batch" 3 $'tests/data/ebf_data/good.ebf\t0\tCONVERTED\ntests/data/ebc_data/bad_mn.ebc\t3\tERROR: Bad Magic Number (tests/data/ebc_data/bad_mn.ebc)\nmissing.ebf\t2\tERROR: Bad File Name (missing.ebf)\ntests/data/ebc_data/bad_data_much.ebc\t6\tERROR: Bad Data (tests/data/ebc_data/bad_data_much.ebc)\ntmp_data/ebz_data/good.ebz\t2\tERROR: Bad File Name (tmp_batch/good.ebu)\ntests/data/ebu_data/good3.ebu\t0\tCONVERTED'
+    run_test ./ebuComp "tmp_batch/good.ebu" "tests/data/ebu_data/good.ebu" 0 "IDENTICAL"
+    run_test ./ebuComp "tmp_batch/good3.ebu" "tests/data/ebu_data/good3.ebu" 0 "IDENTICAL"
+done
+unset BATCH_IO
+rm -rf tmp.list tmp_batch
+
+# an image larger than one strip is converted by a read stage and a write stage running side by side,
+# which gives the same files and the same errors as converting it one strip after another.
+echo "-------------- TESTING pipelined conversion --------------"
+export IMAGE_PIPELINE=on
+cp tests/data/ebu_data/good3.ebu tmp.ebu
+run_test ./ebu2ebc "tmp.ebu" "tmp.ebc" 0 "CONVERTED"
+run_test ./ebconvert "tmp.ebc" "tmp.ebf" 0 "CONVERTED"
+run_test ./ebconvert "tmp.ebf" "tmp.ebz" 0 "CONVERTED"
+run_test ./ebComp "tmp.ebz" "tests/data/ebu_data/good3.ebu" 0 "IDENTICAL"
+# an error after the output was created removes the partly written output, with or without the pipeline
+printf "0" >> tmp.ebu
+rm -f tmp.ebf
+run_test ./ebu2ebf "tmp.ebu" "tmp.ebf" 6 "ERROR: Bad Data (tmp.ebu)"
+run_test ./ebfComp "tmp.ebf" "tests/data/ebf_data/good3.ebf" 2 "ERROR: Bad File Name (tmp.ebf)"
+run_test ./ebu2ebc "tests/data/ebu_data/good3.ebu" "missing/tmp.ebc" 2 "ERROR: Bad File Name (missing/tmp.ebc)"
+export IMAGE_PIPELINE=off
+run_test ./ebu2ebc "tmp.ebu" "tmp.ebc" 6 "ERROR: Bad Data (tmp.ebu)"
+run_test ./ebcComp "tmp.ebc" "tests/data/ebc_data/good3.ebc" 2 "ERROR: Bad File Name (tmp.ebc)"
+unset IMAGE_PIPELINE
+rm -f tmp.ebu tmp.ebc tmp.ebf tmp.ebz
+
+# every vector kernel and any number of pool threads must give the same results, so the ebc, echo, comp
+# and hash cases are run again on an image large enough to be shared among the threads.
+echo "-------------- TESTING kernels and threads --------------"
+./ebconvert tests/data/ebu_data/good3.ebu tmp_data/good3.ebf > null
+sed '500s/^[0-9]*/32/' tmp_data/good3.ebf > tmp_data/bad_data.ebf
+# an ebf payload of twice EBF_PARALLEL_MIN_BYTES or more is parsed in chunks cut at even places in the text,
+# so ebgen makes one of about 10 MB, with bad copies which have rows of values above 31, and a row one value
+# short, around the middle, where every even number of chunks has a cut.
+make ebgen > null
+./ebgen ebf 2000 2000 7 tmp_data/large.ebf > null
+middle=$(( $(head -c $(( $(wc -c < tmp_data/large.ebf) / 2 )) tmp_data/large.ebf | wc -l) + 1 ))
+sed "$(( middle - 1 )),$(( middle + 1 ))s/[0-9][0-9]*/32/g" tmp_data/large.ebf > tmp_data/large_bad_data.ebf
+sed "${middle}s/ [0-9]*$//" tmp_data/large.ebf > tmp_data/large_short.ebf
+for kernel in scalar sse2
+do
+    for threads in 1 4
+    do
+        export EBC_KERNEL=$kernel PIXEL_KERNEL=$kernel HASH_KERNEL=$kernel DIFF_KERNEL=$kernel IMAGE_THREADS=$threads
+        echo "Testing with the $kernel kernels and IMAGE_THREADS=$threads"
+        run_test ./ebu2ebc "tests/data/ebu_data/good3.ebu" "tmp.ebc" 0 "CONVERTED"
+        run_test ./ebcEcho "tmp.ebc" "tmp2.ebc" 0 "ECHOED"
+        run_test ./ebc2ebu "tmp2.ebc" "tmp.ebu" 0 "CONVERTED"
+        run_test ./ebuComp "tmp.ebu" "tests/data/ebu_data/good3.ebu" 0 "IDENTICAL"
+        run_test ./ebcEcho "tests/data/ebc_data/bad_data_much.ebc" "tmp2.ebc" 6 "ERROR: Bad Data (tests/data/ebc_data/bad_data_much.ebc)"
+        run_test ./ebfEcho "tmp_data/good3.ebf" "tmp.ebf" 0 "ECHOED"
+        run_test ./ebfComp "tmp.ebf" "tmp_data/good3.ebf" 0 "IDENTICAL"
+        run_test ./ebfEcho "tmp_data/bad_data.ebf" "tmp.ebf" 6 "ERROR: Bad Data (tmp_data/bad_data.ebf)"
+        run_test ./ebfEcho "tmp_data/large.ebf" "tmp.ebf" 0 "ECHOED"
+        run_test ./ebfComp "tmp.ebf" "tmp_data/large.ebf" 0 "IDENTICAL"
+        run_test ./ebfEcho "tmp_data/large_bad_data.ebf" "tmp.ebf" 6 "ERROR: Bad Data (tmp_data/large_bad_data.ebf)"
+        run_test ./ebfEcho "tmp_data/large_short.ebf" "tmp.ebf" 6 "ERROR: Bad Data (tmp_data/large_short.ebf)"
+        run_test ./ebfComp "--stats tests/data/ebf_data/good.ebf" "tests/data/ebf_data/good3.ebf" 0 $'DIFFERENT\nmismatches: 1 of 90000\nfirst: row 0 column 3\nbox: rows 0 to 0 columns 3 to 3\nmax delta: 10\npsnr: 59.37 dB'
+        run_test ./ebhash "tmp.ebc" "" 0 "d0acfc0ee2e14014"
+        run_test ./ebComp "--hash tmp.ebc" "tmp_data/good3.ebf" 0 "IDENTICAL"
+    done
 done
+unset EBC_KERNEL PIXEL_KERNEL HASH_KERNEL DIFF_KERNEL IMAGE_THREADS
+rm -f tmp.ebu tmp.ebc tmp2.ebc tmp.ebf
+rm -rf tmp_data
 
 ###### DO NOT REMOVE - restoring permissions
 # git will be unable to deal with files when we don't have permissions